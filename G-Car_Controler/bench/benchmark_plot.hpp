@@ -0,0 +1,71 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_BENCH_BENCHMARK_PLOT_HPP
+#define GCAR_BENCH_BENCHMARK_PLOT_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <hnc/benchmark_functions.hpp>
+#include <hnc/system.hpp>
+
+
+/**
+ * @brief Run the versions with hnc::benchmark_functions, print the times and the tabular of the means, write <filename>.pdf with Gnuplot
+ *
+ * The Gnuplot script and data are always written (<filename>.pdf.gnuplot and <filename>.pdf.data),
+ * the PDF only if gnuplot is installed. Same filename between two versions of the code = repeatable baseline.
+ *
+ * @param[in] versions_with_name A std::vector of { function, name }
+ * @param[in] title              Title for Gnuplot and tabular
+ * @param[in] filename           Gnuplot output file (without extension)
+ * @param[in] nb_run             Number of runs for each version
+ * @param[in] y_label            Gnuplot y label
+ *
+ * @return the benchmark with all times
+ */
+inline hnc::benchmark benchmark_plot
+(
+	std::vector<std::pair<std::function<void()>, std::string>> const & versions_with_name,
+	std::string const & title,
+	std::string const & filename,
+	std::size_t const nb_run,
+	std::string const & y_label = "Time (in second)"
+)
+{
+	auto benchmark_functions = hnc::benchmark_functions(versions_with_name, title, filename, nb_run, "Versions", y_label);
+	hnc::benchmark const & benchmark = std::get<0>(benchmark_functions);
+	hnc::gnuplot::gnuplot_boxes & gnuplot = std::get<1>(benchmark_functions);
+	hnc::tabular const & tabular = std::get<2>(benchmark_functions);
+	
+	std::cout << benchmark << std::endl;
+	std::cout << std::endl;
+	std::cout << tabular << std::endl;
+	std::cout << std::endl;
+	
+	gnuplot.write_script_in_file();
+	gnuplot.write_data_in_file();
+	if (hnc::system("gnuplot", gnuplot.script_filename()) != 0)
+	{
+		std::cerr << "gnuplot failed, the script is " << gnuplot.script_filename() << std::endl;
+	}
+	
+	return benchmark;
+}
+
+#endif
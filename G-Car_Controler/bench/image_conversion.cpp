@@ -0,0 +1,115 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include <hnc/benchmark_runner.hpp>
+#include <hnc/to_string.hpp>
+#include <hnc/vector2D.hpp>
+#include <hnc/color.hpp>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <thoth/to_sfml.hpp>
+#include <thoth/to_hnc.hpp>
+
+#include "benchmark_plot.hpp"
+
+
+// Conversion pixel by pixel (setPixel), as before thoth::transpose_rgba8
+sf::Image to_sfml_per_pixel(hnc::vector2D<hnc::color> const & image)
+{
+	sf::Image image_sfml;
+	image_sfml.create(hnc::uint_t(image.nb_row()), hnc::uint_t(image.nb_col()));
+	for (std::size_t i = 0; i < image.nb_row(); ++i)
+	{
+		for (std::size_t j = 0; j < image.nb_col(); ++j)
+		{
+			image_sfml.setPixel(hnc::uint_t(i), hnc::uint_t(j), thoth::to_sfml(image(i, j)));
+		}
+	}
+	return image_sfml;
+}
+
+// Conversion pixel by pixel (getPixel), as before thoth::transpose_rgba8
+hnc::vector2D<hnc::color> to_hnc_per_pixel(sf::Image const & image)
+{
+	hnc::vector2D<hnc::color> image_hnc(image.getSize().x, image.getSize().y);
+	for (std::size_t i = 0; i < image_hnc.nb_row(); ++i)
+	{
+		for (std::size_t j = 0; j < image_hnc.nb_col(); ++j)
+		{
+			image_hnc(i, j) = thoth::to_hnc(image.getPixel(hnc::uint_t(i), hnc::uint_t(j)));
+		}
+	}
+	return image_hnc;
+}
+
+// Benchmark of the conversions between hnc::vector2D<hnc::color> and sf::Image
+// ./bench__image_conversion [width] [height] [nb_repetition]
+int main(int argc, char * argv[])
+{
+	std::size_t const width = (argc > 1) ? std::size_t(std::atoi(argv[1])) : 1920;
+	std::size_t const height = (argc > 2) ? std::size_t(std::atoi(argv[2])) : 1080;
+	std::size_t const nb_repetition = (argc > 3) ? std::size_t(std::atoi(argv[3])) : 20;
+	
+	std::cout << "Image " << width << "x" << height << ", " << nb_repetition << " repetitions" << std::endl;
+	
+	hnc::vector2D<hnc::color> image(width, height);
+	for (std::size_t i = 0; i < width; ++i)
+	{
+		for (std::size_t j = 0; j < height; ++j)
+		{
+			image(i, j) = hnc::color(int(i % 256), int(j % 256), int((i + j) % 256), 255);
+		}
+	}
+	
+	// Check
+	{
+		sf::Image const image_reference = to_sfml_per_pixel(image);
+		sf::Image const image_sfml = thoth::to_sfml(image);
+		hnc::vector2D<hnc::color> const image_hnc_reference = to_hnc_per_pixel(image_sfml);
+		hnc::vector2D<hnc::color> const image_hnc = thoth::to_hnc(image_sfml);
+		if
+		(
+			std::memcmp(image_reference.getPixelsPtr(), image_sfml.getPixelsPtr(), width * height * 4) != 0 ||
+			std::memcmp(image_hnc_reference.data(), image_hnc.data(), width * height * 4) != 0 ||
+			std::memcmp(image.data(), image_hnc.data(), width * height * 4) != 0
+		)
+		{
+			std::cerr << "Error: the bulk conversion is different from the conversion pixel by pixel" << std::endl;
+			return 1;
+		}
+	}
+	
+	sf::Image const image_sfml = thoth::to_sfml(image);
+	
+	benchmark_plot
+	(
+		{
+			{ [&]() { hnc::do_not_optimize(to_sfml_per_pixel(image)); }, "to_sfml per pixel" },
+			{ [&]() { hnc::do_not_optimize(thoth::to_sfml(image)); }, "to_sfml bulk" },
+			{ [&]() { hnc::do_not_optimize(to_hnc_per_pixel(image_sfml)); }, "to_hnc per pixel" },
+			{ [&]() { hnc::do_not_optimize(thoth::to_hnc(image_sfml)); }, "to_hnc bulk" }
+		},
+		"Image conversion " + hnc::to_string(width) + "x" + hnc::to_string(height),
+		"bench_image_conversion",
+		nb_repetition
+	);
+	
+	return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+#include <hnc/benchmark_runner.hpp>
+#include <hnc/vector2D.hpp>
+#include <hnc/color.hpp>
+#include <hnc/vector2.hpp>
+#include <hnc/to_string.hpp>
+
+#include <thoth/textures.hpp>
+#include <thoth/isometric_map.hpp>
+
+#include "benchmark_plot.hpp"
+
+
+// Benchmark of thoth::isometric_map::get_sprite_it (tile under the mouse)
+// ./bench__isometric_map [nb_line] [nb_position] [nb_repetition]
+int main(int argc, char * argv[])
+{
+	std::size_t const nb_line = (argc > 1) ? std::size_t(std::atoi(argv[1])) : 200;
+	std::size_t const nb_position = (argc > 2) ? std::size_t(std::atoi(argv[2])) : 1000000;
+	std::size_t const nb_repetition = (argc > 3) ? std::size_t(std::atoi(argv[3])) : 20;
+	
+	std::size_t const tile_width = 222;
+	std::size_t const tile_height = 128;
+	
+	thoth::texture const texture("bench_isometric_map", hnc::vector2D<hnc::color>(tile_width, tile_height, hnc::color(255, 255, 255, 255)));
+	thoth::isometric_map map(texture, tile_width, tile_height, nb_line);
+	
+	std::cout << map.nb_line() << " lines, " << map.tiles.size() << " tiles, " << nb_position << " positions, " << nb_repetition << " repetitions" << std::endl;
+	
+	// Check: the center of a tile is in the tile
+	for (auto it = map.tiles.begin(); it != map.tiles.end(); ++it)
+	{
+		if (map.get_sprite_it(it->position()) != it)
+		{
+			std::cerr << "Error: the center of the tile " << (it - map.tiles.begin()) << " is not in the tile" << std::endl;
+			return 1;
+		}
+	}
+	
+	// Positions
+	std::vector<hnc::vector2<float>> positions_random;
+	std::vector<hnc::vector2<float>> positions_center;
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> x(0.f, float((nb_line / 2 + 1) * tile_width));
+		std::uniform_real_distribution<float> y(0.f, float((nb_line + 1) * tile_height / 2));
+		for (std::size_t i = 0; i < nb_position; ++i)
+		{
+			positions_random.emplace_back(x(random), y(random));
+			positions_center.push_back(map.tiles[i % map.tiles.size()].position());
+		}
+	}
+	
+	auto get_sprite_it = [&](std::vector<hnc::vector2<float>> const & positions)
+	{
+		std::size_t nb_found = 0;
+		for (hnc::vector2<float> const & position : positions)
+		{
+			if (map.get_sprite_it(position) != map.tiles.end()) { ++nb_found; }
+		}
+		hnc::do_not_optimize(nb_found);
+	};
+	
+	benchmark_plot
+	(
+		{
+			{ [&]() { get_sprite_it(positions_random); }, "random positions" },
+			{ [&]() { get_sprite_it(positions_center); }, "tile centers" }
+		},
+		"isometric_map::get_sprite_it, " + hnc::to_string(nb_position) + " positions",
+		"bench_isometric_map",
+		nb_repetition
+	);
+	
+	return 0;
+}
@@ -0,0 +1,166 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include <hnc/benchmark_runner.hpp>
+#include <hnc/to_string.hpp>
+
+#include <SFML/Network.hpp>
+
+#include <g-car/network/command.hpp>
+#include <g-car/network/command_sender.hpp>
+#include <g-car/network/connection.hpp>
+
+#include "benchmark_plot.hpp"
+
+
+// Benchmark of the commands: encoding, decoding and send over loopback to a G-Car stand-in
+// ./bench__network [nb_command] [nb_repetition] [port]
+int main(int argc, char * argv[])
+{
+	std::size_t const nb_command = (argc > 1) ? std::size_t(std::atoi(argv[1])) : 10000;
+	std::size_t const nb_repetition = (argc > 2) ? std::size_t(std::atoi(argv[2])) : 20;
+	unsigned short int const port = (argc > 3) ? (unsigned short int)(std::atoi(argv[3])) : 54001;
+	
+	std::cout << nb_command << " commands, " << nb_repetition << " repetitions, port " << port << std::endl;
+	
+	// Commands
+	gcar::network::command_encoder encoder;
+	std::vector<std::uint8_t> stream(nb_command * gcar::network::command_size);
+	for (std::size_t i = 0; i < nb_command; ++i)
+	{
+		gcar::network::encode(encoder.make(gcar::network::opcode::drive, float(i % 100), -float(i % 45), 50.f), stream.data() + i * gcar::network::command_size);
+	}
+	
+	// Server of the controller and G-Car stand-in on loopback
+	gcar::network::connection connection(port);
+	connection.start();
+	sf::TcpSocket car;
+	for (std::size_t attempt = 0; car.connect(sf::IpAddress::LocalHost, port, sf::milliseconds(100)) != sf::Socket::Done; ++attempt)
+	{
+		if (attempt == 50)
+		{
+			std::cerr << "Error: can not connect to 127.0.0.1:" << port << std::endl;
+			connection.stop();
+			return 1;
+		}
+		sf::sleep(sf::milliseconds(100));
+	}
+	while (!connection.is_connected()) { std::this_thread::yield(); }
+	
+	// The G-Car parses what it receives
+	std::atomic<std::uint64_t> nb_received(0);
+	std::thread car_thread
+	(
+		[&]()
+		{
+			gcar::network::command_parser parser;
+			char data[4096];
+			std::size_t received = 0;
+			while (car.receive(data, sizeof(data), received) == sf::Socket::Done)
+			{
+				parser.feed(data, received, [&](gcar::network::command const &) { ++nb_received; });
+			}
+		}
+	);
+	auto wait_received = [&](std::uint64_t const n) { while (nb_received < n) { std::this_thread::yield(); } };
+	
+	gcar::network::command_sender sender
+	(
+		[&](void const * data, std::size_t size) { return connection.send(data, size); },
+		0.// No rate limit
+	);
+	sender.start();
+	
+	benchmark_plot
+	(
+		{
+			{
+				[&]()
+				{
+					gcar::network::command_buffer buffer;
+					for (std::size_t i = 0; i < nb_command; ++i)
+					{
+						gcar::network::encode(encoder.make(gcar::network::opcode::drive, float(i % 100), -float(i % 45), 50.f), buffer.data());
+						hnc::do_not_optimize(buffer);
+					}
+				},
+				"encode"
+			},
+			{
+				[&]()
+				{
+					gcar::network::command command;
+					for (std::size_t i = 0; i < nb_command; ++i)
+					{
+						gcar::network::decode(stream.data() + i * gcar::network::command_size, gcar::network::command_size, command);
+						hnc::do_not_optimize(command);
+					}
+				},
+				"decode"
+			},
+			{
+				[&]()
+				{
+					gcar::network::command_parser parser;
+					std::size_t n = 0;
+					parser.feed(stream.data(), stream.size(), [&](gcar::network::command const &) { ++n; });
+					hnc::do_not_optimize(n);
+				},
+				"command_parser::feed"
+			},
+			{
+				[&]()
+				{
+					std::uint64_t const n = nb_received + nb_command;
+					for (std::size_t i = 0; i < nb_command; ++i)
+					{
+						connection.send(stream.data() + i * gcar::network::command_size, gcar::network::command_size);
+					}
+					wait_received(n);
+				},
+				"connection::send"
+			},
+			{
+				[&]()
+				{
+					// Round trip: post, then wait for the G-Car to parse the command
+					for (std::size_t i = 0; i < nb_command / 10; ++i)
+					{
+						std::uint64_t const n = nb_received + 1;
+						sender.post(gcar::network::opcode::drive, float(i % 100), 0.f, 50.f);
+						wait_received(n);
+					}
+				},
+				"command_sender (1/10)"
+			}
+		},
+		"Commands, " + hnc::to_string(nb_command) + " per run",
+		"bench_network",
+		nb_repetition
+	);
+	
+	sender.stop();
+	connection.stop();
+	car_thread.join();
+	
+	return 0;
+}
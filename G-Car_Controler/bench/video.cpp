@@ -0,0 +1,101 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <hnc/benchmark_runner.hpp>
+#include <hnc/to_string.hpp>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <g-car/video/bgr_to_rgba.hpp>
+#include <g-car/video/texture_stream.hpp>
+
+#include "benchmark_plot.hpp"
+
+
+// Benchmark of the frame path of gcar::video::pipeline: BGR to RGBA conversion and texture upload
+// ./bench__video [width] [height] [nb_repetition]
+int main(int argc, char * argv[])
+{
+	int const width = (argc > 1) ? std::atoi(argv[1]) : 640;
+	int const height = (argc > 2) ? std::atoi(argv[2]) : 480;
+	std::size_t const nb_repetition = (argc > 3) ? std::size_t(std::atoi(argv[3])) : 100;
+	
+	std::cout << "Frame " << width << "x" << height << ", " << nb_repetition << " repetitions" << std::endl;
+	
+	cv::Mat bgr(height, width, CV_8UC3);
+	for (int row = 0; row < height; ++row)
+	{
+		std::uint8_t * const pixels = bgr.ptr<std::uint8_t>(row);
+		for (int col = 0; col < width; ++col)
+		{
+			pixels[3 * col + 0] = std::uint8_t(col);
+			pixels[3 * col + 1] = std::uint8_t(row);
+			pixels[3 * col + 2] = std::uint8_t(col + row);
+		}
+	}
+	
+	// Check
+	cv::Mat rgba;
+	gcar::video::bgr_to_rgba(bgr, rgba);
+	{
+		cv::Mat rgba_reference;
+		cv::cvtColor(bgr, rgba_reference, cv::COLOR_BGR2RGBA);
+		if (std::memcmp(rgba.ptr(), rgba_reference.ptr(), std::size_t(width) * std::size_t(height) * 4) != 0)
+		{
+			std::cerr << "Error: gcar::video::bgr_to_rgba is different from cv::cvtColor" << std::endl;
+			return 1;
+		}
+	}
+	
+	// The first upload creates the texture (and the OpenGL context)
+	gcar::video::texture_stream texture_stream;
+	texture_stream.update(rgba);
+	
+	cv::Mat rgba_cv;
+	
+	benchmark_plot
+	(
+		{
+			{ [&]() { cv::cvtColor(bgr, rgba_cv, cv::COLOR_BGR2RGBA); }, "cv::cvtColor" },
+			{ [&]() { gcar::video::bgr_to_rgba(bgr, rgba); }, "bgr_to_rgba" },
+			{
+				[&]()
+				{
+					// Before gcar::video::texture_stream: one sf::Image and one texture allocation per frame
+					sf::Image image;
+					image.create(unsigned(width), unsigned(height), rgba.ptr());
+					sf::Texture texture;
+					texture.loadFromImage(image);
+				},
+				"sf::Image + loadFromImage"
+			},
+			{ [&]() { texture_stream.update(rgba); }, "texture_stream::update" }
+		},
+		"Video frame " + hnc::to_string(width) + "x" + hnc::to_string(height),
+		"bench_video",
+		nb_repetition
+	);
+	
+	return 0;
+}
@@ -0,0 +1,141 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <hnc/to_string.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include <g-car/vision/detector_registry.hpp>
+#include <g-car/vision/motion_detection.hpp>
+
+#include "benchmark_plot.hpp"
+
+
+// Synthetic frames: gradient with a bright rectangle moving across the frame
+std::vector<cv::Mat> synthetic_frames(std::size_t const nb_frame, int const width, int const height)
+{
+	std::vector<cv::Mat> frames;
+	for (std::size_t i = 0; i < nb_frame; ++i)
+	{
+		cv::Mat frame(height, width, CV_8UC3);
+		for (int row = 0; row < height; ++row)
+		{
+			std::uint8_t * const pixels = frame.ptr<std::uint8_t>(row);
+			for (int col = 0; col < 3 * width; ++col) { pixels[col] = std::uint8_t((col / 3 + row) / 4); }
+		}
+		int const x = int(i * 8) % (width - width / 8);
+		cv::rectangle(frame, cv::Rect(x, height / 3, width / 8, height / 4), cv::Scalar(255, 255, 255), -1);
+		frames.push_back(frame);
+	}
+	return frames;
+}
+
+// Benchmark of the analysis of gcar::menu (detectAndDisplay and movement_detection) on recorded frames
+// ./bench__vision [video file] [nb_frame] [nb_repetition] [data directory]
+// Without video file (or "-"), synthetic 640x480 frames are used (no face, only motion)
+int main(int argc, char * argv[])
+{
+	std::string const video_filename = (argc > 1) ? argv[1] : "-";
+	std::size_t const nb_frame = (argc > 2) ? std::size_t(std::atoi(argv[2])) : 100;
+	std::size_t const nb_repetition = (argc > 3) ? std::size_t(std::atoi(argv[3])) : 5;
+	std::string const data_directory = (argc > 4) ? argv[4] : "../data/";
+	
+	// Frames
+	std::vector<cv::Mat> frames;
+	if (video_filename != "-")
+	{
+		cv::VideoCapture video;
+		if (!video.open(video_filename))
+		{
+			std::cerr << "Error: can not open " << video_filename << std::endl;
+			return 1;
+		}
+		cv::Mat frame;
+		while (frames.size() < nb_frame && video.read(frame)) { frames.push_back(frame.clone()); }
+	}
+	else
+	{
+		frames = synthetic_frames(nb_frame, 640, 480);
+	}
+	if (frames.empty())
+	{
+		std::cerr << "Error: no frame" << std::endl;
+		return 1;
+	}
+	std::cout << frames.size() << " frames " << frames.front().cols << "x" << frames.front().rows << ", " << nb_repetition << " repetitions" << std::endl;
+	
+	// Detectors (same configuration as gcar::menu::start_app, face_haar active)
+	gcar::vision::detector_registry detectors;
+	gcar::vision::detector_registry detectors_parallel;
+	if (detectors.load_data(data_directory) == 0 || detectors_parallel.load_data(data_directory) == 0)
+	{
+		std::cerr << "Error: no cascade in " << data_directory << std::endl;
+		return 1;
+	}
+	detectors_parallel.enable_parallel();
+	detectors.set_active("face_haar", true);
+	detectors_parallel.set_active("face_haar", true);
+	
+	// Motion
+	gcar::vision::motion_detection motion(4);
+	gcar::vision::motion_detection motion_full(1);
+	
+	// The frames are drawn on, each version works on a copy
+	cv::Mat work;
+	auto for_each_frame = [&](std::function<void (cv::Mat &)> const & f)
+	{
+		for (cv::Mat const & recorded : frames)
+		{
+			recorded.copyTo(work);
+			f(work);
+		}
+	};
+	
+	benchmark_plot
+	(
+		{
+			{ [&]() { for_each_frame([](cv::Mat &) { }); }, "copy only" },
+			{
+				[&]()
+				{
+					for_each_frame([&](cv::Mat & frame) { if (detectors.detect(frame)) { detectors.draw(frame); } });
+				},
+				"detectAndDisplay"
+			},
+			{
+				[&]()
+				{
+					for_each_frame([&](cv::Mat & frame) { if (detectors_parallel.detect(frame)) { detectors_parallel.draw(frame); } });
+				},
+				"detectAndDisplay parallel"
+			},
+			{ [&]() { for_each_frame([&](cv::Mat & frame) { motion.detect(frame); motion.draw(frame); }); }, "movement_detection" },
+			{ [&]() { for_each_frame([&](cv::Mat & frame) { motion_full.detect(frame); motion_full.draw(frame); }); }, "movement_detection 1/1" }
+		},
+		"Vision, " + hnc::to_string(frames.size()) + " frames",
+		"bench_vision",
+		nb_repetition
+	);
+	
+	return 0;
+}
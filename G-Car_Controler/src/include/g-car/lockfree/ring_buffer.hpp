@@ -0,0 +1,167 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_LOCKFREE_RING_BUFFER_HPP
+#define GCAR_PROJECT_LOCKFREE_RING_BUFFER_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+namespace gcar
+{
+	/**
+	 * @brief Lock-free containers shared by the controller threads
+	 * 
+	 * @code
+		#include "lockfree/ring_buffer.hpp"
+	 * @endcode
+	 * 
+	 */
+	
+	namespace lockfree
+	{
+		/**
+		 * @brief Bounded lock-free ring buffer which drops the oldest element when it is full
+		 * 
+		 * @code
+			#include "lockfree/ring_buffer.hpp"
+		 * @endcode
+		 * 
+		 * One producer thread calls push, one or more consumer threads call pop. @n
+		 * The ring buffer stores pointers: the elements are never copied and the
+		 * dropped element is given back to the producer, which can reuse it
+		 * (no allocation once the pipeline is running).
+		 */
+		template <class T>
+		class ring_buffer
+		{
+		private:
+			
+			/// Capacity
+			std::size_t const m_capacity;
+			
+			/// Slots
+			std::unique_ptr<std::atomic<T *>[]> m_slots;
+			
+			/// Number of elements pushed
+			std::atomic<std::uint64_t> m_head;
+			
+			/// Number of elements popped or dropped
+			std::atomic<std::uint64_t> m_tail;
+			
+			/// Number of elements dropped
+			std::atomic<std::uint64_t> m_nb_drop;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] capacity Maximum number of elements (at least 1)
+			explicit ring_buffer(std::size_t const capacity) :
+				m_capacity(capacity),
+				m_slots(new std::atomic<T *>[capacity]),
+				m_head(0),
+				m_tail(0),
+				m_nb_drop(0)
+			{
+				if (capacity == 0)
+				{
+					throw std::invalid_argument("gcar::lockfree::ring_buffer: capacity must be at least 1");
+				}
+				
+				for (std::size_t i = 0; i < m_capacity; ++i)
+				{
+					m_slots[i].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+			
+			/// @brief No copy
+			ring_buffer(ring_buffer const &) = delete;
+			
+			/// @brief No copy
+			ring_buffer & operator =(ring_buffer const &) = delete;
+			
+			/// @brief Destructor
+			~ring_buffer()
+			{
+				while (pop()) { }
+			}
+			
+			/// @brief Return the capacity
+			/// @return the capacity
+			std::size_t capacity() const { return m_capacity; }
+			
+			/// @brief Return the number of elements (approximation if other threads are working)
+			/// @return the number of elements
+			std::size_t size() const
+			{
+				return std::size_t(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+			}
+			
+			/// @brief Return the number of elements dropped since the construction
+			/// @return the number of elements dropped
+			std::uint64_t nb_drop() const { return m_nb_drop.load(std::memory_order_relaxed); }
+			
+			/// @brief Push an element (producer thread only)
+			/// @param[in] value New element
+			/// @return the oldest element if it was dropped to make room, nullptr otherwise
+			std::unique_ptr<T> push(std::unique_ptr<T> value)
+			{
+				std::unique_ptr<T> dropped;
+				
+				std::uint64_t const head = m_head.load(std::memory_order_relaxed);
+				std::uint64_t tail = m_tail.load(std::memory_order_acquire);
+				
+				// Full: drop the oldest element (a consumer may take it before us)
+				while (head - tail >= m_capacity)
+				{
+					T * const oldest = m_slots[std::size_t(tail % m_capacity)].load(std::memory_order_acquire);
+					if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						dropped.reset(oldest);
+						m_nb_drop.fetch_add(1, std::memory_order_relaxed);
+						break;
+					}
+				}
+				
+				m_slots[std::size_t(head % m_capacity)].store(value.release(), std::memory_order_release);
+				m_head.store(head + 1, std::memory_order_release);
+				
+				return dropped;
+			}
+			
+			/// @brief Pop the oldest element
+			/// @return the oldest element, nullptr if the ring buffer is empty
+			std::unique_ptr<T> pop()
+			{
+				std::uint64_t tail = m_tail.load(std::memory_order_acquire);
+				
+				while (tail != m_head.load(std::memory_order_acquire))
+				{
+					T * const oldest = m_slots[std::size_t(tail % m_capacity)].load(std::memory_order_acquire);
+					if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						return std::unique_ptr<T>(oldest);
+					}
+				}
+				
+				return nullptr;
+			}
+		};
+	}
+	
+}
+#endif
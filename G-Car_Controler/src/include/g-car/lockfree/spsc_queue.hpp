@@ -0,0 +1,185 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_LOCKFREE_SPSC_QUEUE_HPP
+#define GCAR_PROJECT_LOCKFREE_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+namespace gcar
+{
+	namespace lockfree
+	{
+		/**
+		 * @brief Bounded lock-free single-producer single-consumer queue of values
+		 * 
+		 * @code
+			#include "lockfree/spsc_queue.hpp"
+		 * @endcode
+		 * 
+		 * One producer thread calls push, one consumer thread calls pop. @n
+		 * The elements are copied into preallocated slots (for small values like sensor samples);
+		 * when the queue is full, the new element is dropped and counted. @n
+		 * Each side caches the index of the other side to touch the shared cache line only when needed.
+		 */
+		template <class T>
+		class spsc_queue
+		{
+		private:
+			
+			/// Capacity (power of 2)
+			std::size_t const m_capacity;
+			
+			/// m_capacity - 1
+			std::size_t const m_mask;
+			
+			/// Slots
+			std::unique_ptr<T[]> m_slots;
+			
+			/// Number of elements pushed (written by the producer)
+			alignas(64) std::atomic<std::uint64_t> m_head;
+			
+			/// Cache of m_tail (producer only)
+			std::uint64_t m_tail_cache;
+			
+			/// Number of elements dropped (written by the producer)
+			std::atomic<std::uint64_t> m_nb_drop;
+			
+			/// Number of elements popped (written by the consumer)
+			alignas(64) std::atomic<std::uint64_t> m_tail;
+			
+			/// Cache of m_head (consumer only)
+			std::uint64_t m_head_cache;
+			
+			/// @brief Round up to a power of 2
+			/// @param[in] n A number
+			/// @return the smallest power of 2 greater or equal to n
+			static std::size_t power_of_2(std::size_t const n)
+			{
+				std::size_t r = 1;
+				while (r < n) { r *= 2; }
+				return r;
+			}
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] capacity Minimum number of elements (at least 1, rounded up to a power of 2)
+			explicit spsc_queue(std::size_t const capacity) :
+				m_capacity(power_of_2(capacity)),
+				m_mask(m_capacity - 1),
+				m_slots(new T[m_capacity]),
+				m_head(0),
+				m_tail_cache(0),
+				m_nb_drop(0),
+				m_tail(0),
+				m_head_cache(0)
+			{
+				if (capacity == 0)
+				{
+					throw std::invalid_argument("gcar::lockfree::spsc_queue: capacity must be at least 1");
+				}
+			}
+			
+			/// @brief No copy
+			spsc_queue(spsc_queue const &) = delete;
+			
+			/// @brief No copy
+			spsc_queue & operator =(spsc_queue const &) = delete;
+			
+			/// @brief Return the capacity
+			/// @return the capacity
+			std::size_t capacity() const { return m_capacity; }
+			
+			/// @brief Return the number of elements (approximation if other threads are working)
+			/// @return the number of elements
+			std::size_t size() const
+			{
+				return std::size_t(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+			}
+			
+			/// @brief Return the number of elements dropped since the construction
+			/// @return the number of elements dropped
+			std::uint64_t nb_drop() const { return m_nb_drop.load(std::memory_order_relaxed); }
+			
+			/// @brief Push an element (producer thread only)
+			/// @param[in] value New element
+			/// @return true if the element is pushed, false if the queue is full (the element is dropped)
+			bool push(T const & value)
+			{
+				std::uint64_t const head = m_head.load(std::memory_order_relaxed);
+				
+				if (head - m_tail_cache >= m_capacity)
+				{
+					m_tail_cache = m_tail.load(std::memory_order_acquire);
+					if (head - m_tail_cache >= m_capacity)
+					{
+						m_nb_drop.fetch_add(1, std::memory_order_relaxed);
+						return false;
+					}
+				}
+				
+				m_slots[std::size_t(head) & m_mask] = value;
+				m_head.store(head + 1, std::memory_order_release);
+				
+				return true;
+			}
+			
+			/// @brief Pop the oldest element (consumer thread only)
+			/// @param[out] value The oldest element
+			/// @return true if an element is popped, false if the queue is empty
+			bool pop(T & value)
+			{
+				std::uint64_t const tail = m_tail.load(std::memory_order_relaxed);
+				
+				if (tail == m_head_cache)
+				{
+					m_head_cache = m_head.load(std::memory_order_acquire);
+					if (tail == m_head_cache) { return false; }
+				}
+				
+				value = m_slots[std::size_t(tail) & m_mask];
+				m_tail.store(tail + 1, std::memory_order_release);
+				
+				return true;
+			}
+			
+			/// @brief Pop all the elements (consumer thread only)
+			/// @param[in] function Function called for each element, from the oldest
+			/// @return the number of elements popped
+			template <class function_t>
+			std::size_t consume_all(function_t function)
+			{
+				std::uint64_t const tail = m_tail.load(std::memory_order_relaxed);
+				m_head_cache = m_head.load(std::memory_order_acquire);
+				
+				for (std::uint64_t i = tail; i != m_head_cache; ++i)
+				{
+					function(m_slots[std::size_t(i) & m_mask]);
+				}
+				
+				// Release all the slots at once
+				m_tail.store(m_head_cache, std::memory_order_release);
+				
+				return std::size_t(m_head_cache - tail);
+			}
+		};
+	}
+	
+}
+#endif
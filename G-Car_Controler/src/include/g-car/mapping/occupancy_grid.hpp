@@ -0,0 +1,262 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+
+#ifndef GCAR_PROJECT_MAPPING_OCCUPANCY_GRID_HPP
+#define GCAR_PROJECT_MAPPING_OCCUPANCY_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <hnc/vector2D_growable.hpp>
+
+namespace gcar
+{
+	namespace mapping
+	{
+		/**
+		 * @brief Occupancy grid built while the G-Car moves (log-odds per cell)
+		 * 
+		 * @code
+			#include "mapping/occupancy_grid.hpp"
+		 * @endcode
+		 * 
+		 * The map has no fixed size: the cells are stored in a hnc::vector2D_growable
+		 * which grows at the edges (by blocks of grow_step cells) when a measurement leaves the known area. @n
+		 * Each distance measurement marks the cells crossed by the ray as free and the last cell as occupied.
+		 */
+		class occupancy_grid
+		{
+		public:
+			
+			/// Log-odds of a cell (0 is unknown, > 0 is occupied, < 0 is free)
+			using log_odds_t = std::int8_t;
+			
+		private:
+			
+			/// Cells (row = y, column = x)
+			hnc::vector2D_growable<log_odds_t> m_cells;
+			
+			/// Size of a cell (in meters)
+			double m_cell_size;
+			
+			/// Cell coordinates (x) of the column 0
+			long int m_origin_x;
+			
+			/// Cell coordinates (y) of the row 0
+			long int m_origin_y;
+			
+			/// Number of cells added when the grid grows
+			std::size_t m_grow_step;
+			
+			/// Log-odds added to an occupied cell
+			log_odds_t m_hit;
+			
+			/// Log-odds added to a free cell
+			log_odds_t m_miss;
+			
+			/// Bound of the log-odds
+			log_odds_t m_bound;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] cell_size Size of a cell (in meters)
+			/// @param[in] grow_step Number of cells added when the grid grows
+			/// @param[in] hit       Log-odds added to an occupied cell
+			/// @param[in] miss      Log-odds added to a free cell
+			/// @param[in] bound     Bound of the log-odds
+			occupancy_grid
+			(
+				double const cell_size = 0.05, std::size_t const grow_step = 32,
+				log_odds_t const hit = 8, log_odds_t const miss = -2, log_odds_t const bound = 100
+			) :
+				m_cells(),
+				m_cell_size(cell_size),
+				m_origin_x(0),
+				m_origin_y(0),
+				m_grow_step(std::max(grow_step, std::size_t(1))),
+				m_hit(hit),
+				m_miss(miss),
+				m_bound(bound)
+			{ }
+			
+			/// @brief Return the cells (row = y, column = x)
+			/// @return the cells
+			hnc::vector2D_growable<log_odds_t> const & cells() const { return m_cells; }
+			
+			/// @brief Return the size of a cell
+			/// @return the size of a cell (in meters)
+			double cell_size() const { return m_cell_size; }
+			
+			/// @brief Return the cell coordinates (x) of the column 0
+			/// @return the cell coordinates (x) of the column 0
+			long int origin_x() const { return m_origin_x; }
+			
+			/// @brief Return the cell coordinates (y) of the row 0
+			/// @return the cell coordinates (y) of the row 0
+			long int origin_y() const { return m_origin_y; }
+			
+			/// @brief Return the cell coordinate of a position
+			/// @param[in] meters Position (in meters)
+			/// @return the cell coordinate
+			long int to_cell(double const meters) const
+			{
+				return long(std::floor(meters / m_cell_size));
+			}
+			
+			/// @brief Return the log-odds of a cell
+			/// @param[in] x Cell coordinate (x)
+			/// @param[in] y Cell coordinate (y)
+			/// @return the log-odds of the cell, 0 (unknown) outside of the map
+			log_odds_t log_odds(long int const x, long int const y) const
+			{
+				if (contains(x, y) == false) { return 0; }
+				return m_cells(std::size_t(y - m_origin_y), std::size_t(x - m_origin_x));
+			}
+			
+			/// @brief Return the probability for a cell to be occupied
+			/// @param[in] x Cell coordinate (x)
+			/// @param[in] y Cell coordinate (y)
+			/// @return the probability (0.5 for an unknown cell)
+			double probability(long int const x, long int const y) const
+			{
+				return 1.0 - 1.0 / (1.0 + std::exp(double(log_odds(x, y)) / 32.0));
+			}
+			
+			/// @brief Check if a cell is in the map
+			/// @param[in] x Cell coordinate (x)
+			/// @param[in] y Cell coordinate (y)
+			/// @return true if the cell is stored, false otherwise
+			bool contains(long int const x, long int const y) const
+			{
+				return
+					x >= m_origin_x && x < m_origin_x + long(m_cells.nb_col()) &&
+					y >= m_origin_y && y < m_origin_y + long(m_cells.nb_row());
+			}
+			
+			/**
+			 * @brief Grow the map to contain a rectangle of cells
+			 * 
+			 * The rows and the columns are added by blocks of grow_step (one bulk operation per side).
+			 * 
+			 * @param[in] x_min Cell coordinate (x) of the left of the rectangle
+			 * @param[in] y_min Cell coordinate (y) of the top of the rectangle
+			 * @param[in] x_max Cell coordinate (x) of the right of the rectangle
+			 * @param[in] y_max Cell coordinate (y) of the bottom of the rectangle
+			 */
+			void cover(long int const x_min, long int const y_min, long int const x_max, long int const y_max)
+			{
+				// First cell
+				if (m_cells.nb_row() == 0 || m_cells.nb_col() == 0)
+				{
+					m_origin_x = x_min;
+					m_origin_y = y_min;
+					m_cells = hnc::vector2D_growable<log_odds_t>(1, 1, 0);
+				}
+				
+				long int const step = long(m_grow_step);
+				
+				if (x_min < m_origin_x)
+				{
+					std::size_t const n = std::size_t((m_origin_x - x_min + step - 1) / step * step);
+					m_cells.add_cols_front(n, 0);
+					m_origin_x -= long(n);
+				}
+				if (x_max >= m_origin_x + long(m_cells.nb_col()))
+				{
+					long int const missing = x_max - m_origin_x - long(m_cells.nb_col()) + 1;
+					m_cells.add_cols_back(std::size_t((missing + step - 1) / step * step), 0);
+				}
+				if (y_min < m_origin_y)
+				{
+					std::size_t const n = std::size_t((m_origin_y - y_min + step - 1) / step * step);
+					m_cells.add_rows_front(n, 0);
+					m_origin_y -= long(n);
+				}
+				if (y_max >= m_origin_y + long(m_cells.nb_row()))
+				{
+					long int const missing = y_max - m_origin_y - long(m_cells.nb_row()) + 1;
+					m_cells.add_rows_back(std::size_t((missing + step - 1) / step * step), 0);
+				}
+			}
+			
+			/**
+			 * @brief Integrate a distance measurement
+			 * 
+			 * @param[in] x         Position of the sensor (x, in meters)
+			 * @param[in] y         Position of the sensor (y, in meters)
+			 * @param[in] angle     Direction of the sensor (in radians)
+			 * @param[in] distance  Measured distance (in meters)
+			 * @param[in] max_range Range of the sensor (in meters), no obstacle is marked when distance >= max_range
+			 */
+			void integrate(double const x, double const y, double const angle, double const distance, double const max_range)
+			{
+				double const d = std::min(distance, max_range);
+				integrate_ray
+				(
+					to_cell(x), to_cell(y),
+					to_cell(x + d * std::cos(angle)), to_cell(y + d * std::sin(angle)),
+					distance < max_range
+				);
+			}
+			
+			/**
+			 * @brief Mark the cells crossed by a ray as free and the last one as occupied (Bresenham)
+			 * 
+			 * @param[in] x0  Cell coordinate (x) of the sensor
+			 * @param[in] y0  Cell coordinate (y) of the sensor
+			 * @param[in] x1  Cell coordinate (x) of the end of the ray
+			 * @param[in] y1  Cell coordinate (y) of the end of the ray
+			 * @param[in] hit true if there is an obstacle at the end of the ray
+			 */
+			void integrate_ray(long int x0, long int y0, long int const x1, long int const y1, bool const hit)
+			{
+				cover(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1));
+				
+				long int const dx = std::labs(x1 - x0);
+				long int const dy = -std::labs(y1 - y0);
+				long int const sx = (x0 < x1) ? 1 : -1;
+				long int const sy = (y0 < y1) ? 1 : -1;
+				long int error = dx + dy;
+				
+				while (x0 != x1 || y0 != y1)
+				{
+					update(x0, y0, m_miss);
+					long int const e2 = 2 * error;
+					if (e2 >= dy) { error += dy; x0 += sx; }
+					if (e2 <= dx) { error += dx; y0 += sy; }
+				}
+				update(x1, y1, (hit) ? m_hit : m_miss);
+			}
+			
+		private:
+			
+			/// @brief Add log-odds to a cell of the map
+			/// @param[in] x     Cell coordinate (x)
+			/// @param[in] y     Cell coordinate (y)
+			/// @param[in] delta Log-odds added
+			void update(long int const x, long int const y, log_odds_t const delta)
+			{
+				log_odds_t & cell = m_cells(std::size_t(y - m_origin_y), std::size_t(x - m_origin_x));
+				cell = log_odds_t(std::max(-int(m_bound), std::min(int(m_bound), int(cell) + int(delta))));
+			}
+		};
+	}
+}
+
+#endif
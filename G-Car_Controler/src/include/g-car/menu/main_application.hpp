@@ -18,7 +18,9 @@
 #include <concept_check.hpp>
 
 #include <stdio.h>
+#include <atomic>
 #include <thread>
+#include <tuple>
 #include <string.h>
 #include <math.h>
 
@@ -29,6 +31,13 @@
 #include <TGUI/TGUI.hpp>
 
 #include "help_application.hpp"
+#include "../video/pipeline.hpp"
+#include "../video/texture_stream.hpp"
+#include "../network/command_sender.hpp"
+#include "../network/connection.hpp"
+#include "../network/telemetry.hpp"
+#include "../vision/detector_registry.hpp"
+#include "../vision/motion_detection.hpp"
 
 #include <opencv2/core/core.hpp>
 
@@ -59,111 +68,54 @@ namespace gcar
 	{
 		
         ///Serveur
-		sf::TcpListener listener;
-		sf::TcpSocket socket;
-		bool client_ok = false;
+		gcar::network::connection connection(54000);
+		gcar::network::command_sender sender(
+                                             [](void const * data, std::size_t size)
+                                             {
+                                                 return connection.send(data, size);
+                                             },
+                                             100.);// 100 Hz max
+		gcar::network::telemetry telemetry;
         
         ///OpenCV
-        cv::Mat frameRGB, frameRGBA;
-        cv::BackgroundSubtractorMOG2 bg;//(100, 3, 0.3, 5);
-        std::vector < std::vector < cv::Point > >contours;
-        cv::Mat fgmask, fgimg, backgroundImage;
-        std::string face_cascade_name = "../data/haarcascades/haarcascade_frontalface_alt.xml";
-        cv::CascadeClassifier face_cascade;
+        gcar::vision::motion_detection motion(4);// 1/4 resolution, background updated every 2nd frame
+        gcar::vision::detector_registry detectors;// Haar, LBP and HOG cascades of data/, one gray/equalized cache per frame
         std::string window_name = "Capture - Face detection";
         int filenumber; // Number of file to be saved
         std::string filename;
         
         // Function detectAndDisplay
-        void detectAndDisplay(cv::Mat frame)
+        void detectAndDisplay(cv::Mat & frame)
         {
-            std::vector<cv::Rect> faces;
-            cv::Mat frame_gray, crop, res, gray;
-            std::string text;
-            std::stringstream sstm;
-            
-            cvtColor(frame, frame_gray, cv::COLOR_BGR2GRAY);
-            equalizeHist(frame_gray, frame_gray);
-            
-            // Detect faces
-            face_cascade.detectMultiScale(frame_gray, faces, 1.1, 2, 0 | cv::CASCADE_SCALE_IMAGE, cv::Size(30, 30));
-            
-            // Set Region of Interest
-            cv::Rect roi_b;
-            cv::Rect roi_c;
-            
-            size_t ic = 0; // ic is index of current element
-            int ac = 0; // ac is area of current element
-            
-            size_t ib = 0; // ib is index of biggest element
-            int ab = 0; // ab is area of biggest element
-            
-            for (ic = 0; ic < faces.size(); ic++) // Iterate through all current elements (detected faces)
-                
+            // Active detectors (downscaled, tracked), the frame is converted once for all
+            if(detectors.detect(frame))
             {
-                roi_c.x = faces[ic].x;
-                roi_c.y = faces[ic].y;
-                roi_c.width = (faces[ic].width);
-                roi_c.height = (faces[ic].height);
-                
-                ac = roi_c.width * roi_c.height; // Get the area of current element (detected face)
-                
-                roi_b.x = faces[ib].x;
-                roi_b.y = faces[ib].y;
-                roi_b.width = (faces[ib].width);
-                roi_b.height = (faces[ib].height);
-                
-                ab = roi_b.width * roi_b.height; // Get the area of biggest element, at beginning it is same as "current" element
-                
-                if (ac > ab)
-                {
-                    ib = ic;
-                    roi_b.x = faces[ib].x;
-                    roi_b.y = faces[ib].y;
-                    roi_b.width = (faces[ib].width);
-                    roi_b.height = (faces[ib].height);
-                }
-                
-                cv::Point pt1(faces[ic].x, faces[ic].y); // Display detected faces on main window - live stream from camera
-                cv::Point pt2((faces[ic].x + faces[ic].height), (faces[ic].y + faces[ic].width));
-                rectangle(frame, pt1, pt2, cv::Scalar(0, 255, 0), 2, 8, 0);
+                detectors.draw(frame);
             }
-            
         }
 
         /// Détection des movements
-        inline void movement_detection(cv::Mat frame)
+        inline void movement_detection(cv::Mat & frame)
         {
-            bg.operator()(frame, fgimg);
-            bg.getBackgroundImage (backgroundImage);
-            cv::erode (fgimg, fgimg, cv::Mat ());
-            cv::dilate (fgimg, fgimg, cv::Mat ());
-            cv::findContours (fgimg, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
-            cv::drawContours (frame, contours, -1, cv::Scalar (0, 0, 255), 2);
-
+            motion.detect(frame);
+            motion.draw(frame);
         }
         
         
-        /// Accepte la connexion avec le client
-		inline void client_connection() 
-		{
-			listener.accept(socket);
-			client_ok = true;
-		}
-
-        ///Thread connexion
-        sf::Thread t1(&client_connection);
+        /// Envoie une commande (thread d'envoi, la derniere commande de conduite gagne)
+        inline void send_command(gcar::network::opcode const op, float const a = 0.f, float const c = 0.f, float const d = 0.f)
+        {
+            sender.post(op, a, c, d);
+        }
         
         /// Appel des options du menu
-		inline void menu_navigation(sf::RenderWindow & window, sf::TcpSocket & socket, const tgui::Callback& callback)
+		inline void menu_navigation(sf::RenderWindow & window, const tgui::Callback& callback)
 		{
 			std::cout << "You pressed the '" << callback.text.toAnsiString() << "' button." << std::endl;
 			if(callback.text.toAnsiString() == "Exit")
 			{
-				listener.close();
-				socket.disconnect();
-				t1.terminate();
-				exit(0);
+				// Same shutdown as the Closed event (end of start_app)
+				window.close();
 			}
 			else if(callback.text.toAnsiString() == "About")
 			{
@@ -171,33 +123,32 @@ namespace gcar
 			}
 			else if(callback.text.toAnsiString() == "Connect")
 			{
-				t1.launch();
+				connection.start();
 			}
 			else if(callback.text.toAnsiString() == "Disconnect")
 			{
-				client_ok = false;
-				socket.disconnect();
+				connection.disconnect();
 			}
 		}
     
         /// Fenetre principale de l'application
 		inline void start_app (sf::RenderWindow & window)
 		{
-			cv::VideoCapture cap;// open the video file for reading
-            //cap.open("http://192.168.43.1:8080/video?x.mjpeg");
-            if(!face_cascade.load("../data/haarcascades/haarcascade_frontalface_alt2.xml"))
+			gcar::video::pipeline video;// capture, analysis and upload threads
+            //video.open("http://192.168.43.1:8080/video?x.mjpeg");
+            detectors.load_data("../data/");
+            if(!detectors.find("face_haar") && !detectors.find("face_lbp"))
             {
                 printf("Error loading cascade file for face");
                 exit(1);
             }
-            cap.open(0);
-            if(!cap.isOpened())
+            detectors.enable_parallel();// full scans on all the cores (OpenMP)
+            if(!video.open(0))
 			{
 				std::cout << "Fail" << std::endl;
 			}
             
-			sf::Image image;
-			sf::Texture texture;
+			gcar::video::texture_stream texture;
 			sf::Sprite sprite;
 			
 			bool fullscreen = false;
@@ -276,7 +227,7 @@ namespace gcar
 			    btn_start->connect(
 									"pressed", [&]()
 									{
-										socket.send("A -1 C -1 D -1 ", 1024);
+										send_command(gcar::network::opcode::start);
 									}
 								 );
 			    gui.add(btn_start);
@@ -287,7 +238,7 @@ namespace gcar
 			    btn_stop->connect(
 									"pressed", [&]()
 									{
-										socket.send("A 0 C 0 D 0 ", 1024);
+										send_command(gcar::network::opcode::stop);
 									}
 								 );
 			    gui.add(btn_stop);
@@ -298,7 +249,7 @@ namespace gcar
                 radio_auto->connect(
                                       "checked", [&]()
                                       {
-                                          socket.send("A 99 C 99 D 99 ", 1024);
+                                          send_command(gcar::network::opcode::automatic);
                                       }
                                       );
 			    gui.add(radio_auto);
@@ -309,7 +260,7 @@ namespace gcar
                 radio_manuel->connect(
                                    "checked", [&]()
                                    {
-                                       socket.send("A 1 C 1 D 1 ", 1024);
+                                       send_command(gcar::network::opcode::manual);
                                    }
                                    );
 			    gui.add(radio_manuel);
@@ -323,7 +274,7 @@ namespace gcar
 			    menu->addMenuItem("Settings", "Disconnect");
 			    menu->addMenu("Help");
 			    menu->addMenuItem("Help", "About");
-			    menu->connectEx("MenuItemClicked", menu_navigation, std::ref(window), std::ref(socket));
+			    menu->connectEx("MenuItemClicked", menu_navigation, std::ref(window));
 			    gui.add(menu);
 
 				auto label = tgui::Label::create(THEME_CONFIG_FILE);
@@ -343,10 +294,14 @@ namespace gcar
 		        exit(1);
 		    }
 
-			// lie l'écouteur à un port
-			listener.listen(54000);
+			sender.start();
             
-			t1.launch();
+			// Telemetry of the G-Car, decoded on the connection thread
+			connection.on_connect([](){ telemetry.reset(); });
+			connection.on_receive([](void const * data, std::size_t size){ telemetry.feed(data, size); });
+			
+			// écoute le port 54000 (thread de connexion, reconnexion automatique)
+			connection.start();
 			
 			bool joystickConnect = false;
 			sf::Clock clock;
@@ -359,10 +314,32 @@ namespace gcar
 			float frequence = 50000;
 			
             
-            bool face_recognisation = false;
-            bool movement = false;
+            // Read by the analysis thread of the video pipeline
+            std::atomic<bool> face_recognisation(false);
+            std::atomic<bool> pedestrian(false);
+            std::atomic<bool> movement(false);
+            bool fast_face = !detectors.find("face_haar");// LBP: several times faster than Haar
+            
+            auto update_detectors = [&]()
+            {
+                detectors.set_active("face_haar", face_recognisation && !fast_face);
+                detectors.set_active("face_lbp", face_recognisation && fast_face);
+                detectors.set_active("pedestrian_hog", bool(pedestrian));
+            };
             
-            bg.set ("nmixtures", 3);
+            video.start(
+                        [&](cv::Mat & frame)
+                        {
+                            if(face_recognisation || pedestrian)
+                            {
+                                detectAndDisplay(frame);
+                            }
+                            else if (movement)
+                            {
+                                movement_detection(frame);
+                            }
+                        }
+                        );
             
 			// Start
 			while (window.isOpen())
@@ -376,9 +353,6 @@ namespace gcar
 						// Close
 						if (event.type == sf::Event::Closed)
 						{
-							listener.close();
-							socket.disconnect();
-							t1.terminate();
 							window.close();
 						}
                         else if (event.type == sf::Event::KeyReleased)
@@ -393,8 +367,20 @@ namespace gcar
                                {
                                    face_recognisation = true;
                                }
+                               update_detectors();
                             }
-                            else if (event.key.code == sf::Keyboard::M && face_recognisation == false)
+                            else if (event.key.code == sf::Keyboard::L && detectors.find("face_haar") && detectors.find("face_lbp"))
+                            {
+                                // Haar <-> LBP
+                                fast_face = !fast_face;
+                                update_detectors();
+                            }
+                            else if (event.key.code == sf::Keyboard::P && movement == false && detectors.find("pedestrian_hog"))
+                            {
+                                pedestrian = !pedestrian;
+                                update_detectors();
+                            }
+                            else if (event.key.code == sf::Keyboard::M && face_recognisation == false && pedestrian == false)
                             {
                                 if(movement)
                                 {
@@ -422,7 +408,7 @@ namespace gcar
 				
 				float const moving = 30 * elapsed;
 				
-				if(!client_ok)
+				if(!connection.is_connected())
 				{
 					radio_auto->disable();
 					radio_manuel->disable();
@@ -512,9 +498,7 @@ namespace gcar
 						/// Send Data
 						if(bck_move_A != move_A || bck_move_B != move_B)
 						{
-							std::string paquet = "A "+std::to_string((float)move_A/10)+" C "+std::to_string(move_B)+" D  "+std::to_string(frequence)+" ";
-							socket.send(paquet.c_str(), paquet.size()+1);
-							std::cout << "Envoie du paquet : " << paquet.c_str() << std::endl;
+							send_command(gcar::network::opcode::drive, (float)move_A/10, move_B, frequence);
 						}
 					}
 					else if(radio_auto->isChecked())
@@ -525,27 +509,36 @@ namespace gcar
 					
 				}
                 
-				cap >> frameRGB;
+				/// Telemetry: at most one widget update per sensor and per frame
+				telemetry.collect();
+				for (auto const & row : { std::make_tuple(gcar::network::sensor::velocity, "velocity", "Velocity :"),
+				                          std::make_tuple(gcar::network::sensor::distance, "distance", "Distance traveled:"),
+				                          std::make_tuple(gcar::network::sensor::infrared, "infrared", "Infrared:") })
+				{
+					auto const & statistics = telemetry.statistics(std::get<0>(row));
+					if (statistics.nb_sample != 0)
+					{
+						listBox->changeItemById(std::get<1>(row), statistics.to_string(std::get<2>(row)));
+					}
+				}
 				
-				if(!frameRGB.empty())
+				/// Newest frame of the video pipeline (never waits on the camera or the detectors)
+				auto frame = video.newest();
+				
+				if(frame)
 				{
-                    if(face_recognisation)
-                    {
-                        detectAndDisplay(frameRGB);
-                    }
-                    else if (movement)
+                    if(texture.update(frame->rgba))
                     {
-                        movement_detection(frameRGB);
+                        sprite.setTexture(texture.texture(), true);
                     }
+                    
+                    video.recycle(std::move(frame));
 				}
 				
-                cv::cvtColor(frameRGB, frameRGBA, cv::COLOR_BGR2RGBA);
-                image.create(frameRGBA.cols, frameRGBA.rows, frameRGBA.ptr());
-				
-                texture.loadFromImage(image);
-                
-                sprite.setTexture(texture);
-				sprite.setScale((float)window.getSize().x/2 / texture.getSize().x, (float)window.getSize().y/2 / texture.getSize().y);
+				if(texture.is_created())
+				{
+					sprite.setScale((float)window.getSize().x/2 / texture.texture().getSize().x, (float)window.getSize().y/2 / texture.texture().getSize().y);
+				}
 				
 				// Clear the screen
 				window.clear(sf::Color(132,132,130));
@@ -560,6 +553,11 @@ namespace gcar
 				// Display
 				window.display();
 			}
+			
+			// Shutdown: the video threads use the detectors, they are stopped before the network and before the static destruction
+			video.stop();
+			sender.stop();
+			connection.stop();
 		}
 	}
 	
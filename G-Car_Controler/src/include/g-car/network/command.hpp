@@ -0,0 +1,309 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_NETWORK_COMMAND_HPP
+#define GCAR_PROJECT_NETWORK_COMMAND_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+namespace gcar
+{
+	/**
+	 * @brief Provides the network protocol between the controller and the G-Car
+	 * 
+	 * @code
+		#include "network/command.hpp"
+	 * @endcode
+	 * 
+	 */
+	
+	namespace network
+	{
+		/// Version of the binary protocol
+		std::uint8_t const protocol_version = 1;
+		
+		/**
+		 * @brief Size of a command frame (in bytes)
+		 * 
+		 * Layout (big endian):
+		 * - 1 byte:  protocol version
+		 * - 1 byte:  opcode
+		 * - 2 bytes: sequence number
+		 * - 4 bytes: timestamp (milliseconds since the start of the sender)
+		 * - 4 bytes: A (fixed point, 8 bits for the fractional part)
+		 * - 4 bytes: C (fixed point, 8 bits for the fractional part)
+		 * - 4 bytes: D (fixed point, 8 bits for the fractional part)
+		 */
+		std::size_t const command_size = 20;
+		
+		/// Command frame
+		using command_buffer = std::array<std::uint8_t, command_size>;
+		
+		/// Opcodes
+		enum class opcode : std::uint8_t
+		{
+			/// Manual driving (A = speed, C = direction, D = frequency)
+			drive = 1,
+			/// Start the automatic mode
+			start = 2,
+			/// Stop the G-Car
+			stop = 3,
+			/// Switch to automatic mode
+			automatic = 4,
+			/// Switch to manual mode
+			manual = 5
+		};
+		
+		/**
+		 * @brief Command sent to the G-Car
+		 * 
+		 * @code
+			#include "network/command.hpp"
+		 * @endcode
+		 * 
+		 */
+		class command
+		{
+		public:
+			
+			/// Opcode
+			gcar::network::opcode op = gcar::network::opcode::stop;
+			
+			/// Sequence number
+			std::uint16_t sequence = 0;
+			
+			/// Timestamp in milliseconds
+			std::uint32_t timestamp = 0;
+			
+			/// A value
+			float a = 0.f;
+			
+			/// C value
+			float c = 0.f;
+			
+			/// D value
+			float d = 0.f;
+		};
+		
+		/// @brief Convert a float into a fixed point value (8 bits for the fractional part, saturated)
+		/// @param[in] value A float
+		/// @return the fixed point value
+		inline std::int32_t to_fixed(float const value)
+		{
+			double const fixed = std::round(double(value) * 256.);
+			if (fixed >= double(std::numeric_limits<std::int32_t>::max())) { return std::numeric_limits<std::int32_t>::max(); }
+			if (fixed <= double(std::numeric_limits<std::int32_t>::min())) { return std::numeric_limits<std::int32_t>::min(); }
+			return std::int32_t(fixed);
+		}
+		
+		/// @brief Convert a fixed point value (8 bits for the fractional part) into a float
+		/// @param[in] fixed A fixed point value
+		/// @return the float
+		inline float from_fixed(std::int32_t const fixed)
+		{
+			return float(double(fixed) / 256.);
+		}
+		
+		/// @brief Write an unsigned integer in big endian
+		/// @param[out] out   Output bytes
+		/// @param[in]  value Value
+		template <class T>
+		void write_big_endian(std::uint8_t * out, T const value)
+		{
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+			{
+				out[i] = std::uint8_t(value >> (8 * (sizeof(T) - 1 - i)));
+			}
+		}
+		
+		/// @brief Read an unsigned integer in big endian
+		/// @param[in] in Input bytes
+		/// @return the value
+		template <class T>
+		T read_big_endian(std::uint8_t const * in)
+		{
+			T value = 0;
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+			{
+				value = T((value << 8) | in[i]);
+			}
+			return value;
+		}
+		
+		/// @brief Encode a command
+		/// @param[in]  command A command
+		/// @param[out] out     Output bytes (at least gcar::network::command_size bytes)
+		inline void encode(gcar::network::command const & command, std::uint8_t * out)
+		{
+			out[0] = gcar::network::protocol_version;
+			out[1] = std::uint8_t(command.op);
+			write_big_endian(out + 2, command.sequence);
+			write_big_endian(out + 4, command.timestamp);
+			write_big_endian(out + 8, std::uint32_t(to_fixed(command.a)));
+			write_big_endian(out + 12, std::uint32_t(to_fixed(command.c)));
+			write_big_endian(out + 16, std::uint32_t(to_fixed(command.d)));
+		}
+		
+		/// @brief Encode a command
+		/// @param[in] command A command
+		/// @return the command frame
+		inline gcar::network::command_buffer encode(gcar::network::command const & command)
+		{
+			gcar::network::command_buffer buffer;
+			encode(command, buffer.data());
+			return buffer;
+		}
+		
+		/// @brief Decode a command
+		/// @param[in]  in      Input bytes
+		/// @param[in]  size    Number of input bytes
+		/// @param[out] command The decoded command
+		/// @return true if the frame is valid, false otherwise (size, version or opcode)
+		inline bool decode(std::uint8_t const * in, std::size_t const size, gcar::network::command & command)
+		{
+			if (size < gcar::network::command_size || in[0] != gcar::network::protocol_version)
+			{
+				return false;
+			}
+			if (in[1] < std::uint8_t(gcar::network::opcode::drive) || in[1] > std::uint8_t(gcar::network::opcode::manual))
+			{
+				return false;
+			}
+			
+			command.op = gcar::network::opcode(in[1]);
+			command.sequence = read_big_endian<std::uint16_t>(in + 2);
+			command.timestamp = read_big_endian<std::uint32_t>(in + 4);
+			command.a = from_fixed(std::int32_t(read_big_endian<std::uint32_t>(in + 8)));
+			command.c = from_fixed(std::int32_t(read_big_endian<std::uint32_t>(in + 12)));
+			command.d = from_fixed(std::int32_t(read_big_endian<std::uint32_t>(in + 16)));
+			
+			return true;
+		}
+		
+		/**
+		 * @brief Create the commands with the sequence number and the timestamp
+		 * 
+		 * @code
+			#include "network/command.hpp"
+		 * @endcode
+		 * 
+		 */
+		class command_encoder
+		{
+		private:
+			
+			/// Next sequence number
+			std::uint16_t m_sequence;
+			
+			/// Start of the encoder
+			std::chrono::steady_clock::time_point const m_start;
+			
+		public:
+			
+			/// @brief Constructor
+			command_encoder() : m_sequence(0), m_start(std::chrono::steady_clock::now())
+			{ }
+			
+			/// @brief Create a command
+			/// @param[in] op Opcode
+			/// @param[in] a  A value (0 by default)
+			/// @param[in] c  C value (0 by default)
+			/// @param[in] d  D value (0 by default)
+			/// @return the command
+			gcar::network::command make(gcar::network::opcode const op, float const a = 0.f, float const c = 0.f, float const d = 0.f)
+			{
+				gcar::network::command command;
+				command.op = op;
+				command.sequence = m_sequence++;
+				command.timestamp = std::uint32_t
+				(
+					std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count()
+				);
+				command.a = a;
+				command.c = c;
+				command.d = d;
+				return command;
+			}
+		};
+		
+		/**
+		 * @brief Split a TCP stream into commands
+		 * 
+		 * @code
+			#include "network/command.hpp"
+		 * @endcode
+		 * 
+		 * TCP does not keep the frame boundaries: bytes are accumulated until a whole frame is received. @n
+		 * A frame with a wrong version or opcode is skipped.
+		 */
+		class command_parser
+		{
+		private:
+			
+			/// Bytes of the incomplete frame
+			gcar::network::command_buffer m_buffer;
+			
+			/// Number of bytes in m_buffer
+			std::size_t m_size;
+			
+			/// Number of invalid frames
+			std::size_t m_nb_invalid;
+			
+		public:
+			
+			/// @brief Constructor
+			command_parser() : m_buffer(), m_size(0), m_nb_invalid(0)
+			{ }
+			
+			/// @brief Add received bytes
+			/// @param[in] data     Received bytes
+			/// @param[in] size     Number of received bytes
+			/// @param[in] function Function called for each decoded command
+			void feed(void const * data, std::size_t const size, std::function<void (gcar::network::command const &)> const & function)
+			{
+				std::uint8_t const * bytes = static_cast<std::uint8_t const *>(data);
+				
+				for (std::size_t i = 0; i < size; )
+				{
+					std::size_t const n = std::min(gcar::network::command_size - m_size, size - i);
+					std::copy(bytes + i, bytes + i + n, m_buffer.begin() + std::ptrdiff_t(m_size));
+					m_size += n;
+					i += n;
+					
+					if (m_size == gcar::network::command_size)
+					{
+						gcar::network::command command;
+						if (gcar::network::decode(m_buffer.data(), m_size, command)) { function(command); }
+						else { ++m_nb_invalid; }
+						m_size = 0;
+					}
+				}
+			}
+			
+			/// @brief Return the number of invalid frames
+			/// @return the number of invalid frames
+			std::size_t nb_invalid() const { return m_nb_invalid; }
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,321 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_NETWORK_COMMAND_SENDER_HPP
+#define GCAR_PROJECT_NETWORK_COMMAND_SENDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <SFML/Network.hpp>
+
+#include "command.hpp"
+
+namespace gcar
+{
+	namespace network
+	{
+		/**
+		 * @brief Send the commands from a dedicated thread, at a maximum rate, latest value wins
+		 * 
+		 * @code
+			#include "network/command_sender.hpp"
+		 * @endcode
+		 * 
+		 * The UI thread posts commands and never blocks on the network. @n
+		 * Drive commands go in a single-slot mailbox: a drive command posted before the previous one
+		 * is sent replaces it (coalesced), so stale setpoints never queue up behind a slow link. @n
+		 * A stop is never dropped: it has its own flag and is sent before any other command,
+		 * the start commands posted before it are obsolete. @n
+		 * The other control commands (start, automatic, manual) wait in a small queue and are sent before
+		 * the pending drive command, the latest start and the latest mode (automatic or manual) win.
+		 * 
+		 * @code
+			sf::TcpSocket socket;
+			gcar::network::command_sender sender(socket, 100.); // 100 Hz max
+			sender.start();
+			sender.post(gcar::network::opcode::drive, 100.f, 15000.f, 50000.f);
+		 * @endcode
+		 */
+		class command_sender
+		{
+		public:
+			
+			/// Function which sends the bytes on the network (called on the sender thread only)
+			using send_t = std::function<sf::Socket::Status (void const * data, std::size_t size)>;
+			
+		private:
+			
+			/// Send function
+			send_t m_send;
+			
+			/// Minimum duration between two sends
+			std::chrono::steady_clock::duration m_period;
+			
+			/// Encoder (sequence number and timestamp)
+			gcar::network::command_encoder m_encoder;
+			
+			/// Protects the mailbox
+			std::mutex m_mutex;
+			
+			/// Wakes the sender thread up
+			std::condition_variable m_condition;
+			
+			/// Pending drive command
+			gcar::network::command m_drive;
+			
+			/// A drive command is pending
+			bool m_drive_pending;
+			
+			/// A stop command is pending
+			bool m_stop_pending;
+			
+			/// Pending control commands (at most one start and one mode change)
+			std::deque<gcar::network::command> m_controls;
+			
+			/// Sender thread is running
+			bool m_running;
+			
+			/// Sender thread
+			std::thread m_thread;
+			
+			/// Number of commands sent
+			std::atomic<std::uint64_t> m_nb_sent;
+			
+			/// Number of pending commands made obsolete before being sent (replaced drive or stop, removed control)
+			std::atomic<std::uint64_t> m_nb_coalesced;
+			
+			/// Number of commands dropped (send error)
+			std::atomic<std::uint64_t> m_nb_dropped;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] send     Function which sends the bytes (for example gcar::network::connection::send)
+			/// @param[in] max_rate Maximum number of commands sent per second (100 by default)
+			explicit command_sender(send_t send, double const max_rate = 100.) :
+				m_send(send),
+				m_period(),
+				m_encoder(),
+				m_mutex(),
+				m_condition(),
+				m_drive(),
+				m_drive_pending(false),
+				m_stop_pending(false),
+				m_controls(),
+				m_running(false),
+				m_thread(),
+				m_nb_sent(0),
+				m_nb_coalesced(0),
+				m_nb_dropped(0)
+			{
+				set_max_rate(max_rate);
+			}
+			
+			/// @brief Constructor
+			/// @param[in] socket   TCP socket (only the sender thread sends on it)
+			/// @param[in] max_rate Maximum number of commands sent per second (100 by default)
+			explicit command_sender(sf::TcpSocket & socket, double const max_rate = 100.) :
+				command_sender
+				(
+					[&socket](void const * data, std::size_t const size) -> sf::Socket::Status
+					{
+						return socket.send(data, size);
+					},
+					max_rate
+				)
+			{ }
+			
+			/// @brief Destructor
+			~command_sender() { stop(); }
+			
+			/// @brief Set the maximum rate
+			/// @param[in] max_rate Maximum number of commands sent per second (0 for unlimited)
+			void set_max_rate(double const max_rate)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_period = (max_rate > 0.) ?
+					std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1. / max_rate)) :
+					std::chrono::steady_clock::duration::zero();
+			}
+			
+			/// @brief Start the sender thread
+			void start()
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_running) { return; }
+				m_running = true;
+				m_thread = std::thread(&command_sender::run, this);
+			}
+			
+			/// @brief Stop the sender thread (pending commands are not sent)
+			void stop()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_running = false;
+				}
+				m_condition.notify_one();
+				if (m_thread.joinable()) { m_thread.join(); }
+			}
+			
+			/// @brief Post a command (never blocks on the network)
+			/// @param[in] op Opcode
+			/// @param[in] a  A value (0 by default)
+			/// @param[in] c  C value (0 by default)
+			/// @param[in] d  D value (0 by default)
+			void post(gcar::network::opcode const op, float const a = 0.f, float const c = 0.f, float const d = 0.f)
+			{
+				gcar::network::command command;
+				command.op = op;
+				command.a = a;
+				command.c = c;
+				command.d = d;
+				
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					
+					if (op == gcar::network::opcode::drive)
+					{
+						if (m_drive_pending) { ++m_nb_coalesced; }
+						m_drive = command;
+						m_drive_pending = true;
+					}
+					else
+					{
+						// The previous setpoint is obsolete after a control command
+						if (m_drive_pending) { ++m_nb_coalesced; m_drive_pending = false; }
+						
+						if (op == gcar::network::opcode::stop)
+						{
+							// Never dropped, the start commands posted before are obsolete
+							if (m_stop_pending) { ++m_nb_coalesced; }
+							m_stop_pending = true;
+							remove_controls([](gcar::network::opcode const queued) { return queued == gcar::network::opcode::start; });
+						}
+						else
+						{
+							// The latest command of the same kind (start, or mode) wins
+							bool const is_mode = (op == gcar::network::opcode::automatic || op == gcar::network::opcode::manual);
+							remove_controls
+							(
+								[op, is_mode](gcar::network::opcode const queued)
+								{
+									return (queued == op) || (is_mode && (queued == gcar::network::opcode::automatic || queued == gcar::network::opcode::manual));
+								}
+							);
+							m_controls.push_back(command);
+						}
+					}
+				}
+				
+				m_condition.notify_one();
+			}
+			
+			/// @brief Return the number of commands sent
+			/// @return the number of commands sent
+			std::uint64_t nb_sent() const { return m_nb_sent; }
+			
+			/// @brief Return the number of pending commands made obsolete before being sent
+			/// @return the number of coalesced commands (a drive replaced by a newer drive or by a control command,
+			///         a stop posted twice, a start removed by a stop, a control replaced by a newer one of the same kind)
+			std::uint64_t nb_coalesced() const { return m_nb_coalesced; }
+			
+			/// @brief Return the number of commands dropped (send error)
+			/// @return the number of dropped commands
+			std::uint64_t nb_dropped() const { return m_nb_dropped; }
+			
+		private:
+			
+			/// @brief Remove pending control commands (coalesced), the mutex must be locked
+			/// @param[in] predicate Returns true for the opcodes to remove
+			template <class predicate_t>
+			void remove_controls(predicate_t const predicate)
+			{
+				auto const it = std::remove_if
+				(
+					m_controls.begin(), m_controls.end(),
+					[&predicate](gcar::network::command const & command) { return predicate(command.op); }
+				);
+				m_nb_coalesced += std::uint64_t(m_controls.end() - it);
+				m_controls.erase(it, m_controls.end());
+			}
+			
+			/// @brief Sender thread
+			void run()
+			{
+				auto next_send = std::chrono::steady_clock::now();
+				
+				std::unique_lock<std::mutex> lock(m_mutex);
+				
+				while (true)
+				{
+					m_condition.wait(lock, [&]() { return !m_running || m_stop_pending || m_drive_pending || !m_controls.empty(); });
+					if (!m_running) { return; }
+					
+					// Rate limit: commands posted meanwhile are coalesced
+					if (std::chrono::steady_clock::now() < next_send)
+					{
+						m_condition.wait_until(lock, next_send, [&]() { return !m_running; });
+						if (!m_running) { return; }
+					}
+					
+					gcar::network::command command;
+					if (m_stop_pending)
+					{
+						command.op = gcar::network::opcode::stop;
+						m_stop_pending = false;
+					}
+					else if (!m_controls.empty())
+					{
+						command = m_controls.front();
+						m_controls.pop_front();
+					}
+					else if (m_drive_pending)
+					{
+						command = m_drive;
+						m_drive_pending = false;
+					}
+					else
+					{
+						continue;
+					}
+					
+					gcar::network::command const encoded = m_encoder.make(command.op, command.a, command.c, command.d);
+					
+					// Send without the lock, the UI can post during a slow send
+					lock.unlock();
+					{
+						gcar::network::command_buffer const buffer = gcar::network::encode(encoded);
+						if (m_send(buffer.data(), buffer.size()) == sf::Socket::Done) { ++m_nb_sent; }
+						else { ++m_nb_dropped; }
+					}
+					lock.lock();
+					
+					next_send = std::chrono::steady_clock::now() + m_period;
+				}
+			}
+		};
+	}
+	
+}
+#endif
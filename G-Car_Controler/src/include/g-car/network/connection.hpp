@@ -0,0 +1,338 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_NETWORK_CONNECTION_HPP
+#define GCAR_PROJECT_NETWORK_CONNECTION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <SFML/Network.hpp>
+
+#ifdef SFML_SYSTEM_WINDOWS
+	#include <winsock2.h>
+#else
+	#include <sys/socket.h>
+#endif
+
+namespace gcar
+{
+	namespace network
+	{
+		/// States of gcar::network::connection
+		enum class connection_state
+		{
+			/// The connection thread is not running
+			stopped,
+			/// Waiting for the G-Car
+			listening,
+			/// The G-Car is connected
+			connected,
+			/// Closing the connection, sends are refused and the socket is shut down (a blocked send is interrupted)
+			draining,
+			/// Waiting before listening again (backoff)
+			reconnecting
+		};
+		
+		/// @brief Operator << between a std::ostream and a gcar::network::connection_state
+		/// @param[in,out] o     Output stream
+		/// @param[in]     state A gcar::network::connection_state
+		/// @return the output stream
+		inline std::ostream & operator <<(std::ostream & o, gcar::network::connection_state const state)
+		{
+			if (state == gcar::network::connection_state::stopped) { o << "stopped"; }
+			else if (state == gcar::network::connection_state::listening) { o << "listening"; }
+			else if (state == gcar::network::connection_state::connected) { o << "connected"; }
+			else if (state == gcar::network::connection_state::draining) { o << "draining"; }
+			else if (state == gcar::network::connection_state::reconnecting) { o << "reconnecting"; }
+			return o;
+		}
+		
+		/**
+		 * @brief Connection between the controller (server) and the G-Car, driven by a sf::SocketSelector
+		 * 
+		 * @code
+			#include "network/connection.hpp"
+		 * @endcode
+		 * 
+		 * One thread waits on the listener or on the socket with a timeout, it never blocks
+		 * in accept and stops without being terminated. @n
+		 * When the G-Car is lost (or the port can not be bound), the connection goes to the
+		 * reconnecting state and listens again after a backoff (doubled at each failure). @n
+		 * The state is published with an atomic, it can be read from any thread. @n
+		 * A send blocked because the G-Car does not read anymore does not block the close:
+		 * the socket is shut down first, which interrupts the send, then closed.
+		 * 
+		 * @code
+			gcar::network::connection connection(54000);
+			connection.start();
+			if (connection.is_connected()) { connection.send(data, size); }
+			connection.disconnect();
+		 * @endcode
+		 */
+		class connection
+		{
+		private:
+			
+			/// sf::TcpSocket which can be shut down while another thread sends
+			class socket_t : public sf::TcpSocket
+			{
+			public:
+				
+				/// @brief Shut down the reads and the writes (a blocked send returns), the socket stays open (does nothing if it is not connected)
+				void shutdown()
+				{
+					#ifdef SFML_SYSTEM_WINDOWS
+						::shutdown(getHandle(), SD_BOTH);
+					#else
+						::shutdown(getHandle(), SHUT_RDWR);
+					#endif
+				}
+			};
+			
+		public:
+			
+			/// Function called with the received bytes (on the connection thread)
+			using receive_t = std::function<void (void const * data, std::size_t size)>;
+			
+			/// Function called when the G-Car is connected (on the connection thread)
+			using connect_t = std::function<void ()>;
+			
+		private:
+			
+			/// Port
+			unsigned short int const m_port;
+			
+			/// Listener
+			sf::TcpListener m_listener;
+			
+			/// Socket of the G-Car
+			socket_t m_socket;
+			
+			/// Protects the socket between the senders and the close (not the shutdown)
+			std::mutex m_socket_mutex;
+			
+			/// State
+			std::atomic<gcar::network::connection_state> m_state;
+			
+			/// Connection thread is running
+			std::atomic<bool> m_running;
+			
+			/// Disconnection requested by the user
+			std::atomic<bool> m_disconnect_requested;
+			
+			/// Function called with the received bytes
+			receive_t m_on_receive;
+			
+			/// Function called when the G-Car is connected
+			connect_t m_on_connect;
+			
+			/// Connection thread
+			std::thread m_thread;
+			
+		public:
+			
+			/// Time of one sf::SocketSelector wait (the thread checks the requests between two waits)
+			sf::Time const poll_timeout;
+			
+			/// First backoff before listening again
+			sf::Time const backoff_min;
+			
+			/// Maximum backoff before listening again
+			sf::Time const backoff_max;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] port        Port of the server
+			/// @param[in] backoff_min First backoff before listening again (250 ms by default)
+			/// @param[in] backoff_max Maximum backoff before listening again (8 s by default)
+			explicit connection
+			(
+				unsigned short int const port,
+				sf::Time const backoff_min = sf::milliseconds(250),
+				sf::Time const backoff_max = sf::seconds(8)
+			) :
+				m_port(port),
+				m_listener(),
+				m_socket(),
+				m_socket_mutex(),
+				m_state(gcar::network::connection_state::stopped),
+				m_running(false),
+				m_disconnect_requested(false),
+				m_on_receive(),
+				m_on_connect(),
+				m_thread(),
+				poll_timeout(sf::milliseconds(100)),
+				backoff_min(backoff_min),
+				backoff_max(backoff_max)
+			{ }
+			
+			/// @brief Destructor
+			~connection() { stop(); }
+			
+			/// @brief Set the function called with the received bytes (before start)
+			/// @param[in] on_receive Function called on the connection thread
+			void on_receive(receive_t on_receive) { m_on_receive = on_receive; }
+			
+			/// @brief Set the function called when the G-Car is connected (before start)
+			/// @param[in] on_connect Function called on the connection thread, before the first receive
+			void on_connect(connect_t on_connect) { m_on_connect = on_connect; }
+			
+			/// @brief Return the state
+			/// @return the state
+			gcar::network::connection_state state() const { return m_state; }
+			
+			/// @brief The G-Car is connected?
+			/// @return true if the G-Car is connected, false otherwise
+			bool is_connected() const { return m_state == gcar::network::connection_state::connected; }
+			
+			/// @brief Start listening (does nothing if the connection thread is running and no disconnection is requested)
+			void start()
+			{
+				if (m_running && !m_disconnect_requested) { return; }
+				if (m_thread.joinable()) { m_thread.join(); }
+				
+				m_disconnect_requested = false;
+				m_running = true;
+				m_state = gcar::network::connection_state::listening;
+				m_thread = std::thread(&connection::run, this);
+			}
+			
+			/// @brief Close the connection and stop listening, without waiting
+			void disconnect()
+			{
+				m_disconnect_requested = true;
+			}
+			
+			/// @brief Close the connection, stop listening and join the connection thread
+			void stop()
+			{
+				m_disconnect_requested = true;
+				if (m_thread.joinable()) { m_thread.join(); }
+			}
+			
+			/// @brief Send data to the G-Car (from any thread)
+			/// @param[in] data Data
+			/// @param[in] size Size of the data
+			/// @return sf::Socket::Done if the data is sent, sf::Socket::Disconnected if the G-Car is not connected
+			sf::Socket::Status send(void const * data, std::size_t const size)
+			{
+				std::lock_guard<std::mutex> lock(m_socket_mutex);
+				if (!is_connected()) { return sf::Socket::Disconnected; }
+				return m_socket.send(data, size);
+			}
+			
+		private:
+			
+			/// @brief Connection thread
+			void run()
+			{
+				sf::SocketSelector selector;
+				sf::Time backoff = backoff_min;
+				
+				while (!m_disconnect_requested)
+				{
+					// Listen
+					if (m_listener.listen(m_port) != sf::Socket::Done)
+					{
+						std::cerr << "gcar::network::connection: can not listen on port " << m_port << std::endl;
+						wait_backoff(backoff);
+						continue;
+					}
+					m_state = gcar::network::connection_state::listening;
+					
+					// Accept
+					selector.clear();
+					selector.add(m_listener);
+					bool accepted = false;
+					while (!m_disconnect_requested && !accepted)
+					{
+						if (selector.wait(poll_timeout) && selector.isReady(m_listener))
+						{
+							accepted = (m_listener.accept(m_socket) == sf::Socket::Done);
+						}
+					}
+					m_listener.close();
+					if (!accepted) { break; }
+					
+					if (m_on_connect) { m_on_connect(); }
+					m_state = gcar::network::connection_state::connected;
+					backoff = backoff_min;
+					
+					// Receive until the G-Car is lost or a disconnection is requested
+					selector.clear();
+					selector.add(m_socket);
+					bool lost = false;
+					char data[1024];
+					while (!m_disconnect_requested && !lost)
+					{
+						if (selector.wait(poll_timeout) && selector.isReady(m_socket))
+						{
+							std::size_t received = 0;
+							auto const status = m_socket.receive(data, sizeof(data), received);
+							if (status == sf::Socket::Done)
+							{
+								if (m_on_receive) { m_on_receive(data, received); }
+							}
+							else if (status != sf::Socket::NotReady)
+							{
+								lost = true;
+							}
+						}
+					}
+					
+					close_socket();
+					
+					if (lost) { wait_backoff(backoff); }
+				}
+				
+				m_listener.close();
+				m_state = gcar::network::connection_state::stopped;
+				m_running = false;
+			}
+			
+			/// @brief Refuse new sends, interrupt the current send and close the socket
+			void close_socket()
+			{
+				m_state = gcar::network::connection_state::draining;
+				m_socket.shutdown();
+				std::lock_guard<std::mutex> lock(m_socket_mutex);
+				m_socket.disconnect();
+			}
+			
+			/// @brief Wait before listening again (interrupted by a disconnection request)
+			/// @param[in,out] backoff Backoff, doubled for the next time
+			void wait_backoff(sf::Time & backoff)
+			{
+				m_state = gcar::network::connection_state::reconnecting;
+				
+				sf::Clock clock;
+				while (!m_disconnect_requested && clock.getElapsedTime() < backoff)
+				{
+					sf::sleep(std::min(poll_timeout, backoff - clock.getElapsedTime()));
+				}
+				
+				backoff = std::min(backoff * 2.f, backoff_max);
+			}
+		};
+	}
+	
+}
+#endif
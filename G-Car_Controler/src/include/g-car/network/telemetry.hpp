@@ -0,0 +1,339 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_NETWORK_TELEMETRY_HPP
+#define GCAR_PROJECT_NETWORK_TELEMETRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "command.hpp"
+#include "../lockfree/spsc_queue.hpp"
+
+namespace gcar
+{
+	namespace network
+	{
+		/**
+		 * @brief Size of a telemetry frame sent by the G-Car (in bytes)
+		 * 
+		 * Layout (big endian):
+		 * - 1 byte:  protocol version
+		 * - 1 byte:  sensor
+		 * - 2 bytes: sequence number
+		 * - 4 bytes: timestamp (milliseconds since the start of the G-Car)
+		 * - 4 bytes: value (fixed point, 8 bits for the fractional part)
+		 */
+		std::size_t const telemetry_size = 12;
+		
+		/// Telemetry frame
+		using telemetry_buffer = std::array<std::uint8_t, telemetry_size>;
+		
+		/// Sensors of the G-Car
+		enum class sensor : std::uint8_t
+		{
+			/// Velocity
+			velocity = 1,
+			/// Distance traveled
+			distance = 2,
+			/// Infrared
+			infrared = 3
+		};
+		
+		/// Number of sensors
+		std::size_t const nb_sensor = 3;
+		
+		/// @brief Return the index of a sensor (from 0 to nb_sensor - 1)
+		/// @param[in] sensor A sensor
+		/// @return the index of the sensor
+		inline std::size_t sensor_index(gcar::network::sensor const sensor)
+		{
+			return std::size_t(sensor) - 1;
+		}
+		
+		/**
+		 * @brief Sample of a sensor sent by the G-Car
+		 * 
+		 * @code
+			#include "network/telemetry.hpp"
+		 * @endcode
+		 * 
+		 */
+		class telemetry_sample
+		{
+		public:
+			
+			/// Sensor
+			gcar::network::sensor sensor = gcar::network::sensor::velocity;
+			
+			/// Sequence number
+			std::uint16_t sequence = 0;
+			
+			/// Timestamp in milliseconds
+			std::uint32_t timestamp = 0;
+			
+			/// Value
+			float value = 0.f;
+		};
+		
+		/// @brief Encode a telemetry sample
+		/// @param[in]  sample A telemetry sample
+		/// @param[out] out    Output bytes (at least gcar::network::telemetry_size bytes)
+		inline void encode(gcar::network::telemetry_sample const & sample, std::uint8_t * out)
+		{
+			out[0] = gcar::network::protocol_version;
+			out[1] = std::uint8_t(sample.sensor);
+			write_big_endian(out + 2, sample.sequence);
+			write_big_endian(out + 4, sample.timestamp);
+			write_big_endian(out + 8, std::uint32_t(to_fixed(sample.value)));
+		}
+		
+		/// @brief Decode a telemetry sample
+		/// @param[in]  in     Input bytes
+		/// @param[in]  size   Number of input bytes
+		/// @param[out] sample The decoded sample
+		/// @return true if the frame is valid, false otherwise (size, version or sensor)
+		inline bool decode(std::uint8_t const * in, std::size_t const size, gcar::network::telemetry_sample & sample)
+		{
+			if (size < gcar::network::telemetry_size || in[0] != gcar::network::protocol_version)
+			{
+				return false;
+			}
+			if (in[1] < std::uint8_t(gcar::network::sensor::velocity) || in[1] > std::uint8_t(gcar::network::sensor::infrared))
+			{
+				return false;
+			}
+			
+			sample.sensor = gcar::network::sensor(in[1]);
+			sample.sequence = read_big_endian<std::uint16_t>(in + 2);
+			sample.timestamp = read_big_endian<std::uint32_t>(in + 4);
+			sample.value = from_fixed(std::int32_t(read_big_endian<std::uint32_t>(in + 8)));
+			
+			return true;
+		}
+		
+		/**
+		 * @brief Split a TCP stream into telemetry samples
+		 * 
+		 * @code
+			#include "network/telemetry.hpp"
+		 * @endcode
+		 * 
+		 * Same as gcar::network::command_parser for the telemetry frames.
+		 */
+		class telemetry_parser
+		{
+		private:
+			
+			/// Bytes of the incomplete frame
+			gcar::network::telemetry_buffer m_buffer;
+			
+			/// Number of bytes in m_buffer
+			std::size_t m_size;
+			
+			/// Number of invalid frames
+			std::size_t m_nb_invalid;
+			
+		public:
+			
+			/// @brief Constructor
+			telemetry_parser() : m_buffer(), m_size(0), m_nb_invalid(0)
+			{ }
+			
+			/// @brief Forget the incomplete frame (new connection)
+			void reset() { m_size = 0; }
+			
+			/// @brief Add received bytes
+			/// @param[in] data     Received bytes
+			/// @param[in] size     Number of received bytes
+			/// @param[in] function Function called for each decoded sample
+			template <class function_t>
+			void feed(void const * data, std::size_t const size, function_t const & function)
+			{
+				std::uint8_t const * bytes = static_cast<std::uint8_t const *>(data);
+				
+				for (std::size_t i = 0; i < size; )
+				{
+					std::size_t const n = std::min(gcar::network::telemetry_size - m_size, size - i);
+					std::copy(bytes + i, bytes + i + n, m_buffer.begin() + std::ptrdiff_t(m_size));
+					m_size += n;
+					i += n;
+					
+					if (m_size == gcar::network::telemetry_size)
+					{
+						gcar::network::telemetry_sample sample;
+						if (gcar::network::decode(m_buffer.data(), m_size, sample)) { function(sample); }
+						else { ++m_nb_invalid; }
+						m_size = 0;
+					}
+				}
+			}
+			
+			/// @brief Return the number of invalid frames
+			/// @return the number of invalid frames
+			std::size_t nb_invalid() const { return m_nb_invalid; }
+		};
+		
+		/**
+		 * @brief Aggregation of the samples of a sensor received during one frame
+		 * 
+		 * @code
+			#include "network/telemetry.hpp"
+		 * @endcode
+		 * 
+		 */
+		class sensor_statistics
+		{
+		public:
+			
+			/// Number of samples received during the frame
+			std::size_t nb_sample = 0;
+			
+			/// Latest value (kept while no sample is received)
+			float latest = 0.f;
+			
+			/// Minimum of the frame
+			float min = 0.f;
+			
+			/// Maximum of the frame
+			float max = 0.f;
+			
+			/// Mean of the frame
+			float mean = 0.f;
+			
+			/// Sum of the frame
+			double sum = 0.;
+			
+			/// @brief Start a new frame (latest is kept)
+			void clear()
+			{
+				nb_sample = 0;
+				sum = 0.;
+			}
+			
+			/// @brief Add a sample
+			/// @param[in] value Value of the sample
+			void add(float const value)
+			{
+				if (nb_sample == 0) { min = value; max = value; }
+				else { min = std::min(min, value); max = std::max(max, value); }
+				latest = value;
+				sum += double(value);
+				++nb_sample;
+				mean = float(sum / double(nb_sample));
+			}
+			
+			/// @brief Text for the GUI
+			/// @param[in] name Name of the sensor
+			/// @return "name: latest (min min, max max, mean mean, n samples)"
+			std::string to_string(std::string const & name) const
+			{
+				char text[128];
+				std::snprintf
+				(
+					text, sizeof(text), "%s %.2f (min %.2f, max %.2f, mean %.2f, %zu samples)",
+					name.c_str(), double(latest), double(min), double(max), double(mean), nb_sample
+				);
+				return text;
+			}
+		};
+		
+		/**
+		 * @brief Telemetry of the G-Car, received on the connection thread and read once per rendered frame
+		 * 
+		 * @code
+			#include "network/telemetry.hpp"
+		 * @endcode
+		 * 
+		 * The connection thread decodes the samples and pushes them in a lock-free SPSC queue (feed). @n
+		 * The GUI thread drains the queue once per frame and aggregates the samples per sensor (collect),
+		 * so a 1 kHz sensor costs one widget update per frame, not one per sample. @n
+		 * If the GUI thread is too slow, the queue is full and the new samples are dropped (nb_drop).
+		 */
+		class telemetry
+		{
+		private:
+			
+			/// Decoded samples (connection thread -> GUI thread)
+			gcar::lockfree::spsc_queue<gcar::network::telemetry_sample> m_queue;
+			
+			/// Parser (connection thread)
+			gcar::network::telemetry_parser m_parser;
+			
+			/// Statistics of the last collected frame (GUI thread)
+			std::array<gcar::network::sensor_statistics, gcar::network::nb_sensor> m_statistics;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] capacity Maximum number of samples between two frames (4096 by default)
+			explicit telemetry(std::size_t const capacity = 4096) :
+				m_queue(capacity),
+				m_parser(),
+				m_statistics()
+			{ }
+			
+			/// @brief Forget the incomplete frame (connection thread, new connection)
+			void reset() { m_parser.reset(); }
+			
+			/// @brief Add received bytes (connection thread)
+			/// @param[in] data Received bytes
+			/// @param[in] size Number of received bytes
+			void feed(void const * data, std::size_t const size)
+			{
+				m_parser.feed
+				(
+					data, size,
+					[this](gcar::network::telemetry_sample const & sample) { m_queue.push(sample); }
+				);
+			}
+			
+			/// @brief Aggregate the samples received since the last call (GUI thread, once per frame)
+			/// @return the statistics of the sensors for this frame
+			std::array<gcar::network::sensor_statistics, gcar::network::nb_sensor> const & collect()
+			{
+				for (auto & statistics : m_statistics) { statistics.clear(); }
+				
+				m_queue.consume_all
+				(
+					[this](gcar::network::telemetry_sample const & sample)
+					{
+						m_statistics[gcar::network::sensor_index(sample.sensor)].add(sample.value);
+					}
+				);
+				
+				return m_statistics;
+			}
+			
+			/// @brief Return the statistics of a sensor for the last collected frame (GUI thread)
+			/// @param[in] sensor A sensor
+			/// @return the statistics of the sensor
+			gcar::network::sensor_statistics const & statistics(gcar::network::sensor const sensor) const
+			{
+				return m_statistics[gcar::network::sensor_index(sensor)];
+			}
+			
+			/// @brief Return the number of samples dropped because the GUI thread was too slow
+			/// @return the number of samples dropped
+			std::uint64_t nb_drop() const { return m_queue.nb_drop(); }
+		};
+	}
+	
+}
+#endif
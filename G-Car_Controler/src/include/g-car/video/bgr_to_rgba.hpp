@@ -0,0 +1,107 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VIDEO_BGR_TO_RGBA_HPP
+#define GCAR_PROJECT_VIDEO_BGR_TO_RGBA_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSSE3__)
+	#include <tmmintrin.h>
+#endif
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace gcar
+{
+	namespace video
+	{
+		/**
+		 * @brief Convert BGR pixels into RGBA pixels (alpha = 255)
+		 * 
+		 * @code
+			#include "video/bgr_to_rgba.hpp"
+		 * @endcode
+		 * 
+		 * Uses SSSE3 (4 pixels per shuffle) when the compiler enables it, a scalar loop otherwise
+		 * 
+		 * @param[in]  bgr      BGR pixels (3 * nb_pixel bytes)
+		 * @param[out] rgba     RGBA pixels (4 * nb_pixel bytes)
+		 * @param[in]  nb_pixel Number of pixels
+		 */
+		inline void bgr_to_rgba(std::uint8_t const * bgr, std::uint8_t * rgba, std::size_t const nb_pixel)
+		{
+			std::size_t i = 0;
+			
+			#if defined(__SSSE3__)
+				__m128i const shuffle = _mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128);
+				__m128i const alpha = _mm_set1_epi32(int(0xFF000000));
+				
+				// One load of 16 bytes for 4 pixels (12 bytes), stop before reading past the end
+				for (; i + 6 <= nb_pixel; i += 4)
+				{
+					__m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bgr + 3 * i));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(rgba + 4 * i), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+				}
+			#endif
+			
+			for (; i < nb_pixel; ++i)
+			{
+				rgba[4 * i + 0] = bgr[3 * i + 2];
+				rgba[4 * i + 1] = bgr[3 * i + 1];
+				rgba[4 * i + 2] = bgr[3 * i + 0];
+				rgba[4 * i + 3] = 255;
+			}
+		}
+		
+		/**
+		 * @brief Convert a BGR cv::Mat into a RGBA cv::Mat
+		 * 
+		 * @code
+			#include "video/bgr_to_rgba.hpp"
+		 * @endcode
+		 * 
+		 * rgba is allocated only if its size changes, so a reused frame costs one copy and no allocation. @n
+		 * Define gcar_video_opencv_conversion to use cv::cvtColor instead of gcar::video::bgr_to_rgba
+		 * 
+		 * @param[in]  bgr  A CV_8UC3 cv::Mat
+		 * @param[out] rgba A CV_8UC4 cv::Mat (continuous)
+		 */
+		inline void bgr_to_rgba(cv::Mat const & bgr, cv::Mat & rgba)
+		{
+			#ifdef gcar_video_opencv_conversion
+				cv::cvtColor(bgr, rgba, cv::COLOR_BGR2RGBA);
+			#else
+				rgba.create(bgr.rows, bgr.cols, CV_8UC4);
+				
+				if (bgr.isContinuous())
+				{
+					gcar::video::bgr_to_rgba(bgr.ptr<std::uint8_t>(), rgba.ptr<std::uint8_t>(), bgr.total());
+				}
+				else
+				{
+					for (int row = 0; row < bgr.rows; ++row)
+					{
+						gcar::video::bgr_to_rgba(bgr.ptr<std::uint8_t>(row), rgba.ptr<std::uint8_t>(row), std::size_t(bgr.cols));
+					}
+				}
+			#endif
+		}
+	}
+	
+}
+#endif
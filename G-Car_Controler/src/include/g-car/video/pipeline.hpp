@@ -0,0 +1,319 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VIDEO_PIPELINE_HPP
+#define GCAR_PROJECT_VIDEO_PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "../lockfree/ring_buffer.hpp"
+#include "bgr_to_rgba.hpp"
+
+namespace gcar
+{
+	/**
+	 * @brief Provides the video functions
+	 * 
+	 * @code
+		#include "video/pipeline.hpp"
+	 * @endcode
+	 * 
+	 */
+	
+	namespace video
+	{
+		/**
+		 * @brief One camera frame and its RGBA version ready to be uploaded
+		 * 
+		 * @code
+			#include "video/pipeline.hpp"
+		 * @endcode
+		 * 
+		 */
+		class frame
+		{
+		public:
+			
+			/// Frame from the camera (BGR), detections are drawn on it
+			cv::Mat bgr;
+			
+			/// Frame converted for SFML (RGBA, allocated once and reused)
+			cv::Mat rgba;
+			
+			/// Frame number
+			std::uint64_t id = 0;
+		};
+		
+		/**
+		 * @brief Video pipeline: capture, analysis and upload stages, each on its own thread
+		 * 
+		 * @code
+			#include "video/pipeline.hpp"
+		 * @endcode
+		 * 
+		 * The stages are joined by gcar::lockfree::ring_buffer which drop the oldest frame
+		 * when the next stage is late. @n
+		 * The render loop takes the newest ready frame with newest(), it never waits on the
+		 * camera or on the detectors. @n
+		 * The upload stage prepares the RGBA pixels; the OpenGL upload itself stays on the
+		 * render thread which owns the OpenGL context.
+		 * 
+		 * @code
+			gcar::video::pipeline video;
+			video.open(0);
+			video.start([](cv::Mat & frame) { detectAndDisplay(frame); });
+			
+			while (window.isOpen())
+			{
+				auto frame = video.newest();
+				if (frame)
+				{
+					// Upload frame->rgba
+					video.recycle(std::move(frame));
+				}
+			}
+		 * @endcode
+		 */
+		class pipeline
+		{
+		public:
+			
+			/// Pointer to a frame
+			using frame_ptr = std::unique_ptr<gcar::video::frame>;
+			
+			/// Analysis function (called on the analysis thread)
+			using analysis_t = std::function<void (cv::Mat & frame)>;
+			
+		private:
+			
+			/// Camera
+			cv::VideoCapture m_capture;
+			
+			/// Analysis function
+			analysis_t m_analysis;
+			
+			/// Frames captured, waiting for the analysis
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_captured;
+			
+			/// Frames analysed, waiting for the upload
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_analysed;
+			
+			/// Frames ready to be drawn
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_ready;
+			
+			/// Frames dropped by the analysis, to be reused by the capture
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_free_analysis;
+			
+			/// Frames dropped by the upload, to be reused by the capture
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_free_upload;
+			
+			/// Frames given back by the render loop, to be reused by the capture
+			gcar::lockfree::ring_buffer<gcar::video::frame> m_free_render;
+			
+			/// Threads are running
+			std::atomic<bool> m_running;
+			
+			/// Number of frames captured
+			std::atomic<std::uint64_t> m_nb_frame;
+			
+			/// Capture thread
+			std::thread m_thread_capture;
+			
+			/// Analysis thread
+			std::thread m_thread_analysis;
+			
+			/// Upload thread
+			std::thread m_thread_upload;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] capacity Number of frames between two stages (2 by default)
+			explicit pipeline(std::size_t const capacity = 2) :
+				m_capture(),
+				m_analysis(),
+				m_captured(capacity),
+				m_analysed(capacity),
+				m_ready(capacity),
+				m_free_analysis(capacity + 1),
+				m_free_upload(capacity + 1),
+				m_free_render(capacity + 1),
+				m_running(false),
+				m_nb_frame(0)
+			{ }
+			
+			/// @brief Destructor
+			~pipeline() { stop(); }
+			
+			/// @brief Open a camera
+			/// @param[in] device Id of the camera
+			/// @return true if the camera is opened, false otherwise
+			bool open(int const device)
+			{
+				m_capture.open(device);
+				return m_capture.isOpened();
+			}
+			
+			/// @brief Open a video file or a stream
+			/// @param[in] filename Filename or URL
+			/// @return true if the video is opened, false otherwise
+			bool open(std::string const & filename)
+			{
+				m_capture.open(filename);
+				return m_capture.isOpened();
+			}
+			
+			/// @brief Start the threads
+			/// @param[in] analysis Analysis function (nullptr by default)
+			void start(analysis_t analysis = nullptr)
+			{
+				if (m_running) { return; }
+				
+				m_analysis = analysis;
+				m_running = true;
+				
+				m_thread_capture = std::thread(&pipeline::capture_loop, this);
+				m_thread_analysis = std::thread(&pipeline::analysis_loop, this);
+				m_thread_upload = std::thread(&pipeline::upload_loop, this);
+			}
+			
+			/// @brief Stop and join the threads
+			void stop()
+			{
+				m_running = false;
+				
+				if (m_thread_capture.joinable()) { m_thread_capture.join(); }
+				if (m_thread_analysis.joinable()) { m_thread_analysis.join(); }
+				if (m_thread_upload.joinable()) { m_thread_upload.join(); }
+			}
+			
+			/// @brief Take the newest ready frame, older ready frames are recycled
+			/// @return the newest ready frame, nullptr if there is no new frame
+			frame_ptr newest()
+			{
+				frame_ptr frame = m_ready.pop();
+				
+				if (frame)
+				{
+					for (frame_ptr next = m_ready.pop(); next; next = m_ready.pop())
+					{
+						m_free_render.push(std::move(frame));
+						frame = std::move(next);
+					}
+				}
+				
+				return frame;
+			}
+			
+			/// @brief Give back a frame to the capture (render thread only)
+			/// @param[in] frame A frame taken with newest()
+			void recycle(frame_ptr frame)
+			{
+				if (frame) { m_free_render.push(std::move(frame)); }
+			}
+			
+			/// @brief Return the number of frames captured
+			/// @return the number of frames captured
+			std::uint64_t nb_frame() const { return m_nb_frame; }
+			
+			/// @brief Return the number of frames dropped between the stages
+			/// @return the number of frames dropped
+			std::uint64_t nb_frame_dropped() const
+			{
+				return m_captured.nb_drop() + m_analysed.nb_drop() + m_ready.nb_drop();
+			}
+			
+		private:
+			
+			/// @brief Wait a little when a stage has nothing to do
+			static void idle()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			
+			/// @brief Return a frame from the free list (or a new one)
+			/// @return a frame
+			frame_ptr take_free()
+			{
+				frame_ptr frame = m_free_render.pop();
+				if (!frame) { frame = m_free_upload.pop(); }
+				if (!frame) { frame = m_free_analysis.pop(); }
+				if (!frame) { frame.reset(new gcar::video::frame()); }
+				return frame;
+			}
+			
+			/// @brief Capture stage
+			void capture_loop()
+			{
+				frame_ptr frame = take_free();
+				
+				while (m_running)
+				{
+					if (!m_capture.isOpened() || !m_capture.read(frame->bgr) || frame->bgr.empty())
+					{
+						idle();
+						continue;
+					}
+					
+					frame->id = m_nb_frame++;
+					
+					frame_ptr dropped = m_captured.push(std::move(frame));
+					frame = dropped ? std::move(dropped) : take_free();
+				}
+			}
+			
+			/// @brief Analysis stage
+			void analysis_loop()
+			{
+				while (m_running)
+				{
+					frame_ptr frame = m_captured.pop();
+					if (!frame) { idle(); continue; }
+					
+					if (m_analysis) { m_analysis(frame->bgr); }
+					
+					frame_ptr dropped = m_analysed.push(std::move(frame));
+					if (dropped) { m_free_analysis.push(std::move(dropped)); }
+				}
+			}
+			
+			/// @brief Upload stage (conversion into RGBA pixels)
+			void upload_loop()
+			{
+				while (m_running)
+				{
+					frame_ptr frame = m_analysed.pop();
+					if (!frame) { idle(); continue; }
+					
+					gcar::video::bgr_to_rgba(frame->bgr, frame->rgba);
+					
+					frame_ptr dropped = m_ready.push(std::move(frame));
+					if (dropped) { m_free_upload.push(std::move(dropped)); }
+				}
+			}
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,76 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VIDEO_TEXTURE_STREAM_HPP
+#define GCAR_PROJECT_VIDEO_TEXTURE_STREAM_HPP
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include <opencv2/core/core.hpp>
+
+namespace gcar
+{
+	namespace video
+	{
+		/**
+		 * @brief Persistent sf::Texture updated in place with the frames of the video
+		 * 
+		 * @code
+			#include "video/texture_stream.hpp"
+		 * @endcode
+		 * 
+		 * The texture is created once (and again only if the size of the video changes),
+		 * then each frame is uploaded with sf::Texture::update directly from the RGBA pixels:
+		 * no sf::Image copy and no OpenGL texture allocation per frame.
+		 */
+		class texture_stream
+		{
+		private:
+			
+			/// Texture
+			sf::Texture m_texture;
+			
+		public:
+			
+			/// @brief Upload a frame
+			/// @param[in] rgba A continuous CV_8UC4 cv::Mat
+			/// @return true if the texture was (re)created, false if it was only updated
+			bool update(cv::Mat const & rgba)
+			{
+				bool created = false;
+				
+				if (m_texture.getSize().x != unsigned(rgba.cols) || m_texture.getSize().y != unsigned(rgba.rows))
+				{
+					m_texture.create(unsigned(rgba.cols), unsigned(rgba.rows));
+					created = true;
+				}
+				
+				m_texture.update(rgba.ptr());
+				
+				return created;
+			}
+			
+			/// @brief Return the texture
+			/// @return the texture
+			sf::Texture const & texture() const { return m_texture; }
+			
+			/// @brief The texture has been created?
+			/// @return true if the texture has a size, false otherwise
+			bool is_created() const { return m_texture.getSize().x != 0 && m_texture.getSize().y != 0; }
+		};
+	}
+	
+}
+#endif
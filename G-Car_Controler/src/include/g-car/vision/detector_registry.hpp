@@ -0,0 +1,251 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_DETECTOR_REGISTRY_HPP
+#define GCAR_PROJECT_VISION_DETECTOR_REGISTRY_HPP
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/objdetect/objdetect.hpp>
+
+#include "face_detection.hpp"
+#include "frame_cache.hpp"
+
+namespace gcar
+{
+	namespace vision
+	{
+		/**
+		 * @brief One cascade detector of the registry
+		 * 
+		 * @code
+			#include "vision/detector_registry.hpp"
+		 * @endcode
+		 * 
+		 */
+		class detector
+		{
+		public:
+			
+			/// Name
+			std::string const name;
+			
+			/// Path of the cascade file
+			std::string const path;
+			
+			/// Cascade (Haar, LBP or HOG features, the type is read from the file)
+			cv::CascadeClassifier cascade;
+			
+			/// Detection context (downscale factor and tracking)
+			gcar::vision::face_detection detection;
+			
+			/// Copies of the cascade for the parallel full scans
+			gcar::vision::parallel_cascade parallel;
+			
+			/// Color of the detections
+			cv::Scalar color;
+			
+			/// The detector runs on the frames (can be changed by another thread)
+			std::atomic<bool> active;
+			
+			/// The state changed, the tracks are reset before the next detection (on the analysis thread)
+			std::atomic<bool> reset_requested;
+			
+			/// @brief Constructor
+			/// @param[in] name      Name
+			/// @param[in] path      Path of the cascade file
+			/// @param[in] downscale Downscale factor
+			/// @param[in] min_size  Minimum size of an object at full resolution
+			/// @param[in] color     Color of the detections
+			detector(std::string const & name, std::string const & path, int const downscale, cv::Size const min_size, cv::Scalar const & color) :
+				name(name),
+				path(path),
+				cascade(),
+				detection(downscale, min_size),
+				parallel(),
+				color(color),
+				active(false),
+				reset_requested(false)
+			{ }
+		};
+		
+		/**
+		 * @brief Cascade detectors loaded at startup, sharing one gcar::vision::frame_cache per frame
+		 * 
+		 * @code
+			#include "vision/detector_registry.hpp"
+		 * @endcode
+		 * 
+		 * The detectors are added before the video starts (add, load_data). @n
+		 * Then the analysis thread calls detect and draw, and any thread can activate or deactivate a detector. @n
+		 * The color conversion and the histogram equalization are done once per frame and per downscale factor,
+		 * whatever the number of active detectors ("face + pedestrian" does not convert the frame twice).
+		 */
+		class detector_registry
+		{
+		private:
+			
+			/// Detectors
+			std::vector<std::unique_ptr<gcar::vision::detector>> m_detectors;
+			
+			/// Images of the current frame
+			gcar::vision::frame_cache m_cache;
+			
+		public:
+			
+			/// @brief Default constructor
+			detector_registry() : m_detectors(), m_cache()
+			{ }
+			
+			/// @brief Load a cascade and add a detector (inactive)
+			/// @param[in] name      Name of the detector
+			/// @param[in] path      Path of the cascade file
+			/// @param[in] downscale Downscale factor (2 by default)
+			/// @param[in] min_size  Minimum size of an object at full resolution (30x30 by default)
+			/// @param[in] color     Color of the detections (green by default)
+			/// @return true if the cascade is loaded, false otherwise
+			bool add
+			(
+				std::string const & name, std::string const & path,
+				int const downscale = 2, cv::Size const min_size = cv::Size(30, 30),
+				cv::Scalar const & color = cv::Scalar(0, 255, 0)
+			)
+			{
+				std::unique_ptr<gcar::vision::detector> detector(new gcar::vision::detector(name, path, downscale, min_size, color));
+				
+				if (!detector->cascade.load(path))
+				{
+					std::cerr << "gcar::vision::detector_registry: can not load " << path << std::endl;
+					return false;
+				}
+				
+				m_detectors.push_back(std::move(detector));
+				return true;
+			}
+			
+			/// @brief Load the cascades of the data directory
+			/// @param[in] data_directory Data directory ("../data/" by default)
+			/// @return the number of detectors loaded
+			/// 
+			/// Detectors: "face_haar", "face_lbp", "profile_lbp" and "pedestrian_hog"
+			std::size_t load_data(std::string const & data_directory = "../data/")
+			{
+				std::size_t n = 0;
+				n += add("face_haar", data_directory + "haarcascades/haarcascade_frontalface_alt2.xml", 2, cv::Size(30, 30), cv::Scalar(0, 255, 0));
+				n += add("face_lbp", data_directory + "lbpcascades/lbpcascade_frontalface.xml", 2, cv::Size(30, 30), cv::Scalar(0, 255, 0));
+				n += add("profile_lbp", data_directory + "lbpcascades/lbpcascade_profileface.xml", 2, cv::Size(30, 30), cv::Scalar(255, 255, 0));
+				n += add("pedestrian_hog", data_directory + "hogcascades/hogcascade_pedestrians.xml", 2, cv::Size(48, 96), cv::Scalar(255, 0, 255));
+				return n;
+			}
+			
+			/// @brief Evaluate the full scans of the detectors on all the cores (before the video starts)
+			/// @return the number of detectors in parallel mode
+			/// 
+			/// See gcar::vision::parallel_cascade (stripes with overlap and non-maximum suppression)
+			std::size_t enable_parallel()
+			{
+				std::size_t n = 0;
+				for (auto & detector : m_detectors)
+				{
+					if (detector->parallel.load(detector->path))
+					{
+						detector->detection.tracker().parallel = &detector->parallel;
+						++n;
+					}
+				}
+				return n;
+			}
+			
+			/// @brief Return a detector
+			/// @param[in] name Name of the detector
+			/// @return the detector, nullptr if there is no detector with this name
+			gcar::vision::detector * find(std::string const & name)
+			{
+				for (auto & detector : m_detectors)
+				{
+					if (detector->name == name) { return detector.get(); }
+				}
+				return nullptr;
+			}
+			
+			/// @brief Activate or deactivate a detector (the tracks are reset if the state changes)
+			/// @param[in] name   Name of the detector
+			/// @param[in] active New state
+			/// @return true if the detector exists, false otherwise
+			bool set_active(std::string const & name, bool const active)
+			{
+				gcar::vision::detector * const detector = find(name);
+				if (detector == nullptr) { return false; }
+				if (detector->active.exchange(active) != active) { detector->reset_requested = true; }
+				return true;
+			}
+			
+			/// @brief Return true if a detector is active
+			/// @param[in] name Name of the detector
+			/// @return true if the detector exists and is active
+			bool is_active(std::string const & name)
+			{
+				gcar::vision::detector * const detector = find(name);
+				return detector != nullptr && detector->active;
+			}
+			
+			/// @brief Return the detectors
+			/// @return the detectors
+			std::vector<std::unique_ptr<gcar::vision::detector>> const & detectors() const { return m_detectors; }
+			
+			/// @brief Return the images of the last frame
+			/// @return the images of the last frame
+			gcar::vision::frame_cache const & cache() const { return m_cache; }
+			
+			/// @brief Run the active detectors on a frame (analysis thread)
+			/// @param[in] frame BGR frame
+			/// @return true if at least one detector is active
+			bool detect(cv::Mat const & frame)
+			{
+				m_cache.reset(frame);
+				
+				bool one_active = false;
+				for (auto & detector : m_detectors)
+				{
+					if (detector->active)
+					{
+						// The tracks are old after a toggle, restart with a full scan
+						if (detector->reset_requested.exchange(false)) { detector->detection.tracker().reset(); }
+						detector->detection.detect(m_cache, detector->cascade);
+						one_active = true;
+					}
+				}
+				return one_active;
+			}
+			
+			/// @brief Draw the detections of the active detectors (analysis thread)
+			/// @param[in,out] frame BGR frame
+			void draw(cv::Mat & frame) const
+			{
+				for (auto const & detector : m_detectors)
+				{
+					if (detector->active) { detector->detection.draw(frame, detector->color, detector->color * 0.5); }
+				}
+			}
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,165 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_FACE_DETECTION_HPP
+#define GCAR_PROJECT_VISION_FACE_DETECTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/objdetect/objdetect.hpp>
+
+#include "face_tracker.hpp"
+#include "frame_cache.hpp"
+
+namespace gcar
+{
+	namespace vision
+	{
+		/**
+		 * @brief Face (or any object of a cascade) detection context: buffers reused from frame to frame and detection on a downscaled image
+		 * 
+		 * @code
+			#include "vision/face_detection.hpp"
+		 * @endcode
+		 * 
+		 * The cascade works on the equalized grayscale frame reduced by the downscale factor (1, 2, 4...)
+		 * from a gcar::vision::frame_cache, then the faces are mapped back to the full resolution. @n
+		 * A factor of 2 divides the cascade work by about 4, a factor of 4 by about 16
+		 * (the minimum face size is divided by the factor too).
+		 */
+		class face_detection
+		{
+		private:
+			
+			/// Downscale factor
+			int m_downscale;
+			
+			/// Tracker (on the downscaled image)
+			gcar::vision::face_tracker m_tracker;
+			
+			/// Faces at full resolution
+			std::vector<cv::Rect> m_faces;
+			
+			/// Index of the biggest face (m_faces.size() if there is no face)
+			std::size_t m_biggest;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] downscale Downscale factor (2 by default)
+			/// @param[in] min_size  Minimum size of a face at full resolution (30x30 by default)
+			explicit face_detection(int const downscale = 2, cv::Size const min_size = cv::Size(30, 30)) :
+				m_downscale(1),
+				m_tracker(),
+				m_faces(),
+				m_biggest(0)
+			{
+				set_downscale(downscale, min_size);
+			}
+			
+			/// @brief Set the downscale factor (the tracks are reset)
+			/// @param[in] downscale Downscale factor (at least 1)
+			/// @param[in] min_size  Minimum size of a face at full resolution (30x30 by default)
+			void set_downscale(int const downscale, cv::Size const min_size = cv::Size(30, 30))
+			{
+				if (downscale < 1)
+				{
+					throw std::invalid_argument("gcar::vision::face_detection: the downscale factor must be at least 1");
+				}
+				
+				m_downscale = downscale;
+				m_tracker.min_size = cv::Size(std::max(min_size.width / downscale, 1), std::max(min_size.height / downscale, 1));
+				m_tracker.reset();
+			}
+			
+			/// @brief Return the downscale factor
+			/// @return the downscale factor
+			int downscale() const { return m_downscale; }
+			
+			/// @brief Return the tracker (to change its parameters)
+			/// @return the tracker
+			gcar::vision::face_tracker & tracker() { return m_tracker; }
+			
+			/// @brief Detect the faces of a frame
+			/// @param[in] cache   Images of the frame
+			/// @param[in] cascade Cascade classifier
+			/// @return the faces at full resolution (valid until the next call)
+			std::vector<cv::Rect> const & detect(gcar::vision::frame_cache & cache, cv::CascadeClassifier & cascade)
+			{
+				m_faces.clear();
+				
+				// Detect and map back to the full resolution
+				auto const & faces = m_tracker.detect(cache.equalized(m_downscale), cascade);
+				cv::Rect const image(0, 0, cache.frame().cols, cache.frame().rows);
+				for (auto const & face : faces)
+				{
+					m_faces.push_back
+					(
+						cv::Rect(face.x * m_downscale, face.y * m_downscale, face.width * m_downscale, face.height * m_downscale) & image
+					);
+				}
+				
+				// Biggest face
+				m_biggest = std::size_t
+				(
+					std::max_element
+					(
+						m_faces.begin(), m_faces.end(),
+						[](cv::Rect const & a, cv::Rect const & b) { return a.area() < b.area(); }
+					)
+					- m_faces.begin()
+				);
+				
+				return m_faces;
+			}
+			
+			/// @brief Return the faces of the last frame
+			/// @return the faces at full resolution
+			std::vector<cv::Rect> const & faces() const { return m_faces; }
+			
+			/// @brief Return true if a face was detected in the last frame
+			/// @return true if a face was detected in the last frame
+			bool has_face() const { return m_biggest < m_faces.size(); }
+			
+			/// @brief Return the biggest face of the last frame (has_face() must be true)
+			/// @return the biggest face at full resolution
+			cv::Rect const & biggest() const { return m_faces[m_biggest]; }
+			
+			/// @brief Draw the faces of the last frame
+			/// @param[in,out] frame         BGR frame
+			/// @param[in]     biggest_color Color of the biggest face (green by default)
+			/// @param[in]     other_color   Color of the other faces (yellow by default)
+			void draw
+			(
+				cv::Mat & frame,
+				cv::Scalar const & biggest_color = cv::Scalar(0, 255, 0), cv::Scalar const & other_color = cv::Scalar(0, 255, 255)
+			) const
+			{
+				for (std::size_t i = 0; i < m_faces.size(); ++i)
+				{
+					cv::Scalar const & color = (i == m_biggest) ? biggest_color : other_color;
+					cv::rectangle(frame, m_faces[i].tl(), m_faces[i].br(), color, 2, 8, 0);
+				}
+			}
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,263 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_FACE_TRACKER_HPP
+#define GCAR_PROJECT_VISION_FACE_TRACKER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/objdetect/objdetect.hpp>
+
+#include "parallel_detection.hpp"
+
+namespace gcar
+{
+	/**
+	 * @brief Provides the computer vision functions
+	 * 
+	 * @code
+		#include "vision/face_tracker.hpp"
+	 * @endcode
+	 * 
+	 */
+	
+	namespace vision
+	{
+		/**
+		 * @brief Detect-then-track with a cascade classifier
+		 * 
+		 * @code
+			#include "vision/face_tracker.hpp"
+		 * @endcode
+		 * 
+		 * A full scan of the image runs every full_scan_period frames, or on the same frame when a track is lost
+		 * (the rectangles of a lost track are never reported). @n
+		 * Between two full scans, the cascade only searches a padded region around each previous detection,
+		 * with a window size close to the previous one. If the cascade misses the object in its region,
+		 * the previous patch is searched by template matching (for max_template_frames frames at most). @n
+		 * The images are grayscale (and equalized if the cascade needs it).
+		 */
+		class face_tracker
+		{
+		public:
+			
+			/// Frames between two full scans (1 = full scan at each frame)
+			std::size_t full_scan_period = 10;
+			
+			/// Padding of the search region (proportion of the size of the detection)
+			double roi_padding = 0.5;
+			
+			/// Scale factor of the cascade
+			double scale_factor = 1.1;
+			
+			/// Minimum neighbors of the cascade
+			int min_neighbors = 2;
+			
+			/// Minimum size of a detection for a full scan
+			cv::Size min_size = cv::Size(30, 30);
+			
+			/// Minimum score of the template matching (normalized correlation)
+			double min_template_score = 0.6;
+			
+			/// Maximum number of consecutive frames tracked by template matching
+			std::size_t max_template_frames = 5;
+			
+			/// Parallel cascade for the full scans (nullptr: the cascade runs on the calling thread)
+			gcar::vision::parallel_cascade * parallel = nullptr;
+			
+		private:
+			
+			/// One tracked object
+			class track
+			{
+			public:
+				
+				/// Position in the image
+				cv::Rect rect;
+				
+				/// Patch of the last cascade detection (for template matching)
+				cv::Mat patch;
+				
+				/// Number of consecutive frames tracked by template matching
+				std::size_t nb_template_frames = 0;
+			};
+			
+			/// Tracked objects
+			std::vector<track> m_tracks;
+			
+			/// Detections of the current frame
+			std::vector<cv::Rect> m_detections;
+			
+			/// Detections in one region (reused)
+			std::vector<cv::Rect> m_roi_detections;
+			
+			/// Result of the template matching (reused)
+			cv::Mat m_match;
+			
+			/// Frames since the last full scan
+			std::size_t m_nb_frame_since_scan;
+			
+			/// The tracks are not valid (reset), full scan at the next frame
+			bool m_lost;
+			
+			/// Number of full scans
+			std::size_t m_nb_full_scan;
+			
+			/// Number of tracked frames
+			std::size_t m_nb_tracked;
+			
+		public:
+			
+			/// @brief Constructor
+			face_tracker() :
+				m_tracks(),
+				m_detections(),
+				m_roi_detections(),
+				m_match(),
+				m_nb_frame_since_scan(0),
+				m_lost(true),
+				m_nb_full_scan(0),
+				m_nb_tracked(0)
+			{ }
+			
+			/// @brief Forget the tracks (the next frame is a full scan)
+			void reset()
+			{
+				m_tracks.clear();
+				m_lost = true;
+			}
+			
+			/// @brief Detect or track the objects in a frame
+			/// @param[in] gray    Grayscale image
+			/// @param[in] cascade Cascade classifier
+			/// @return the detections (valid until the next call)
+			std::vector<cv::Rect> const & detect(cv::Mat const & gray, cv::CascadeClassifier & cascade)
+			{
+				if (m_lost || m_tracks.empty() || m_nb_frame_since_scan + 1 >= full_scan_period)
+				{
+					full_scan(gray, cascade);
+				}
+				else if (!track_all(gray, cascade))
+				{
+					// A track is lost: scan this frame instead of reporting its old rectangle
+					full_scan(gray, cascade);
+				}
+				
+				m_detections.clear();
+				for (auto const & t : m_tracks) { m_detections.push_back(t.rect); }
+				
+				return m_detections;
+			}
+			
+			/// @brief Return the number of full scans
+			/// @return the number of full scans
+			std::size_t nb_full_scan() const { return m_nb_full_scan; }
+			
+			/// @brief Return the number of frames processed without full scan
+			/// @return the number of frames processed without full scan
+			std::size_t nb_tracked() const { return m_nb_tracked; }
+			
+		private:
+			
+			/// @brief Scan the whole image and restart the tracks
+			/// @param[in] gray    Grayscale image
+			/// @param[in] cascade Cascade classifier
+			void full_scan(cv::Mat const & gray, cv::CascadeClassifier & cascade)
+			{
+				if (parallel != nullptr && parallel->is_loaded())
+				{
+					parallel->detect(gray, m_roi_detections, scale_factor, min_neighbors, min_size);
+				}
+				else
+				{
+					cascade.detectMultiScale(gray, m_roi_detections, scale_factor, min_neighbors, 0 | cv::CASCADE_SCALE_IMAGE, min_size);
+				}
+				
+				m_tracks.resize(m_roi_detections.size());
+				for (std::size_t i = 0; i < m_roi_detections.size(); ++i)
+				{
+					m_tracks[i].rect = m_roi_detections[i];
+					gray(m_roi_detections[i]).copyTo(m_tracks[i].patch);
+					m_tracks[i].nb_template_frames = 0;
+				}
+				
+				m_nb_frame_since_scan = 0;
+				m_lost = false;
+				++m_nb_full_scan;
+			}
+			
+			/// @brief Search each track around its previous position
+			/// @param[in] gray    Grayscale image
+			/// @param[in] cascade Cascade classifier
+			/// @return false if a track is lost (the tracks must not be used, full scan needed), true otherwise
+			bool track_all(cv::Mat const & gray, cv::CascadeClassifier & cascade)
+			{
+				cv::Rect const image(0, 0, gray.cols, gray.rows);
+				
+				for (auto & t : m_tracks)
+				{
+					// Padded region
+					int const pad_x = int(t.rect.width * roi_padding);
+					int const pad_y = int(t.rect.height * roi_padding);
+					cv::Rect const roi = cv::Rect(t.rect.x - pad_x, t.rect.y - pad_y, t.rect.width + 2 * pad_x, t.rect.height + 2 * pad_y) & image;
+					if (roi.width < t.rect.width || roi.height < t.rect.height) { return false; }
+					
+					// Cascade with a window close to the previous size
+					cascade.detectMultiScale
+					(
+						gray(roi), m_roi_detections, scale_factor, min_neighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+						cv::Size(t.rect.width * 3 / 4, t.rect.height * 3 / 4),
+						cv::Size(t.rect.width * 4 / 3, t.rect.height * 4 / 3)
+					);
+					
+					if (!m_roi_detections.empty())
+					{
+						auto const best = std::max_element
+						(
+							m_roi_detections.begin(), m_roi_detections.end(),
+							[](cv::Rect const & a, cv::Rect const & b) { return a.area() < b.area(); }
+						);
+						t.rect = cv::Rect(best->x + roi.x, best->y + roi.y, best->width, best->height) & image;
+						gray(t.rect).copyTo(t.patch);
+						t.nb_template_frames = 0;
+						continue;
+					}
+					
+					// Template matching of the previous patch
+					if (t.nb_template_frames >= max_template_frames || t.patch.empty()) { return false; }
+					
+					cv::matchTemplate(gray(roi), t.patch, m_match, CV_TM_CCOEFF_NORMED);
+					double score = 0;
+					cv::Point position;
+					cv::minMaxLoc(m_match, nullptr, &score, nullptr, &position);
+					if (score < min_template_score) { return false; }
+					
+					t.rect = cv::Rect(position.x + roi.x, position.y + roi.y, t.patch.cols, t.patch.rows);
+					++t.nb_template_frames;
+				}
+				
+				++m_nb_frame_since_scan;
+				++m_nb_tracked;
+				return true;
+			}
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,174 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_FRAME_CACHE_HPP
+#define GCAR_PROJECT_VISION_FRAME_CACHE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace gcar
+{
+	namespace vision
+	{
+		/**
+		 * @brief Grayscale and equalized versions of a frame, computed once per frame and shared by the detectors
+		 * 
+		 * @code
+			#include "vision/frame_cache.hpp"
+		 * @endcode
+		 * 
+		 * The images are computed on demand for each downscale factor (1, 2, 4...) and kept until the next frame. @n
+		 * The buffers are reused from frame to frame (no allocation if the frame size does not change).
+		 */
+		class frame_cache
+		{
+		private:
+			
+			/// Images of one downscale factor
+			class level
+			{
+			public:
+				
+				/// Downscale factor
+				int downscale = 1;
+				
+				/// Downscaled frame (BGR)
+				cv::Mat small;
+				
+				/// Grayscale image
+				cv::Mat gray;
+				
+				/// Equalized grayscale image
+				cv::Mat equalized;
+				
+				/// gray is computed for the current frame
+				bool has_gray = false;
+				
+				/// equalized is computed for the current frame
+				bool has_equalized = false;
+			};
+			
+			/// Current frame (BGR)
+			cv::Mat m_frame;
+			
+			/// Levels
+			std::vector<level> m_levels;
+			
+			/// Number of color conversions since the construction
+			std::size_t m_nb_conversion;
+			
+			/// Number of equalizations since the construction
+			std::size_t m_nb_equalization;
+			
+		public:
+			
+			/// @brief Default constructor
+			frame_cache() : m_frame(), m_levels(), m_nb_conversion(0), m_nb_equalization(0)
+			{ }
+			
+			/// @brief Start a new frame
+			/// @param[in] frame BGR frame (not copied, must live until the next call)
+			void reset(cv::Mat const & frame)
+			{
+				m_frame = frame;
+				for (auto & l : m_levels) { l.has_gray = false; l.has_equalized = false; }
+			}
+			
+			/// @brief Return the current frame
+			/// @return the current frame (BGR)
+			cv::Mat const & frame() const { return m_frame; }
+			
+			/// @brief Return the grayscale image
+			/// @param[in] downscale Downscale factor (1 by default)
+			/// @return the grayscale downscaled frame
+			cv::Mat const & gray(int const downscale = 1)
+			{
+				level & l = get_level(downscale);
+				
+				if (!l.has_gray)
+				{
+					if (downscale == 1)
+					{
+						cv::cvtColor(m_frame, l.gray, cv::COLOR_BGR2GRAY);
+					}
+					else
+					{
+						// Reduce first: the conversion works on the small image
+						cv::resize(m_frame, l.small, cv::Size(m_frame.cols / downscale, m_frame.rows / downscale), 0, 0, cv::INTER_AREA);
+						cv::cvtColor(l.small, l.gray, cv::COLOR_BGR2GRAY);
+					}
+					l.has_gray = true;
+					++m_nb_conversion;
+				}
+				
+				return l.gray;
+			}
+			
+			/// @brief Return the equalized grayscale image
+			/// @param[in] downscale Downscale factor (1 by default)
+			/// @return the equalized grayscale downscaled frame
+			cv::Mat const & equalized(int const downscale = 1)
+			{
+				level & l = get_level(downscale);
+				
+				if (!l.has_equalized)
+				{
+					cv::equalizeHist(gray(downscale), l.equalized);
+					l.has_equalized = true;
+					++m_nb_equalization;
+				}
+				
+				return l.equalized;
+			}
+			
+			/// @brief Return the number of color conversions since the construction
+			/// @return the number of color conversions
+			std::size_t nb_conversion() const { return m_nb_conversion; }
+			
+			/// @brief Return the number of equalizations since the construction
+			/// @return the number of equalizations
+			std::size_t nb_equalization() const { return m_nb_equalization; }
+			
+		private:
+			
+			/// @brief Return the level of a downscale factor (created if needed)
+			/// @param[in] downscale Downscale factor
+			/// @return the level
+			level & get_level(int const downscale)
+			{
+				if (downscale < 1)
+				{
+					throw std::invalid_argument("gcar::vision::frame_cache: the downscale factor must be at least 1");
+				}
+				
+				for (auto & l : m_levels)
+				{
+					if (l.downscale == downscale) { return l; }
+				}
+				
+				m_levels.emplace_back();
+				m_levels.back().downscale = downscale;
+				return m_levels.back();
+			}
+		};
+	}
+	
+}
+#endif
@@ -0,0 +1,162 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_MOTION_DETECTION_HPP
+#define GCAR_PROJECT_VISION_MOTION_DETECTION_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/video/background_segm.hpp>
+
+namespace gcar
+{
+	namespace vision
+	{
+		/**
+		 * @brief Motion detection on a downscaled frame, reported as rectangles
+		 * 
+		 * @code
+			#include "vision/motion_detection.hpp"
+		 * @endcode
+		 * 
+		 * The background model (MOG2, 3 mixtures) works on the frame reduced by the downscale factor
+		 * and is updated every update_period frames; between two updates, the previous regions are kept. @n
+		 * Only the bounding boxes of the moving regions are scaled back to the full resolution. @n
+		 * The buffers and the contour storage are reused from frame to frame.
+		 */
+		class motion_detection
+		{
+		public:
+			
+			/// Frames between two updates of the background model (1 = every frame)
+			std::size_t update_period = 2;
+			
+			/// Minimum area of a moving region (in pixels of the downscaled frame)
+			int min_area = 16;
+			
+		private:
+			
+			/// Downscale factor
+			int m_downscale;
+			
+			/// Background model
+			cv::BackgroundSubtractorMOG2 m_subtractor;
+			
+			/// Downscaled frame
+			cv::Mat m_small;
+			
+			/// Foreground mask
+			cv::Mat m_mask;
+			
+			/// Contours (storage reused)
+			std::vector<std::vector<cv::Point>> m_contours;
+			
+			/// Moving regions at full resolution
+			std::vector<cv::Rect> m_regions;
+			
+			/// Number of frames
+			std::size_t m_nb_frame;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] downscale Downscale factor (4 by default)
+			explicit motion_detection(int const downscale = 4) :
+				m_downscale(downscale),
+				m_subtractor(),
+				m_small(),
+				m_mask(),
+				m_contours(),
+				m_regions(),
+				m_nb_frame(0)
+			{
+				if (downscale < 1)
+				{
+					throw std::invalid_argument("gcar::vision::motion_detection: the downscale factor must be at least 1");
+				}
+				
+				m_subtractor.set("nmixtures", 3);
+			}
+			
+			/// @brief Return the downscale factor
+			/// @return the downscale factor
+			int downscale() const { return m_downscale; }
+			
+			/// @brief Detect the moving regions of a frame
+			/// @param[in] frame BGR frame
+			/// @return the moving regions at full resolution (valid until the next call)
+			std::vector<cv::Rect> const & detect(cv::Mat const & frame)
+			{
+				bool const update = (update_period <= 1 || m_nb_frame % update_period == 0);
+				++m_nb_frame;
+				if (!update) { return m_regions; }
+				
+				// Background model on the small frame
+				if (m_downscale == 1)
+				{
+					m_subtractor(frame, m_mask);
+				}
+				else
+				{
+					cv::resize(frame, m_small, cv::Size(frame.cols / m_downscale, frame.rows / m_downscale), 0, 0, cv::INTER_AREA);
+					m_subtractor(m_small, m_mask);
+				}
+				
+				// Foreground only (MOG2 marks the shadows with 127), noise removed
+				cv::threshold(m_mask, m_mask, 200, 255, cv::THRESH_BINARY);
+				cv::erode(m_mask, m_mask, cv::Mat());
+				cv::dilate(m_mask, m_mask, cv::Mat());
+				
+				// Bounding boxes of the regions
+				cv::findContours(m_mask, m_contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+				
+				m_regions.clear();
+				cv::Rect const image(0, 0, frame.cols, frame.rows);
+				for (auto const & contour : m_contours)
+				{
+					cv::Rect const r = cv::boundingRect(contour);
+					if (r.area() < min_area) { continue; }
+					m_regions.push_back
+					(
+						cv::Rect(r.x * m_downscale, r.y * m_downscale, r.width * m_downscale, r.height * m_downscale) & image
+					);
+				}
+				
+				return m_regions;
+			}
+			
+			/// @brief Return the moving regions of the last frame
+			/// @return the moving regions at full resolution
+			std::vector<cv::Rect> const & regions() const { return m_regions; }
+			
+			/// @brief Draw the moving regions of the last frame
+			/// @param[in,out] frame BGR frame
+			/// @param[in]     color Color of the regions (red by default)
+			void draw(cv::Mat & frame, cv::Scalar const & color = cv::Scalar(0, 0, 255)) const
+			{
+				for (auto const & r : m_regions)
+				{
+					cv::rectangle(frame, r.tl(), r.br(), color, 2, 8, 0);
+				}
+			}
+		};
+	}
+	
+}
+#endif
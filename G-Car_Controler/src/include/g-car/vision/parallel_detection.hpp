@@ -0,0 +1,176 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GCAR_PROJECT_VISION_PARALLEL_DETECTION_HPP
+#define GCAR_PROJECT_VISION_PARALLEL_DETECTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/objdetect/objdetect.hpp>
+
+#include <hnc/openmp.hpp>
+
+namespace gcar
+{
+	namespace vision
+	{
+		/// @brief Remove the rectangles which overlap a bigger one (non-maximum suppression, the area is the score)
+		/// @param[in,out] rects             Rectangles
+		/// @param[in]     overlap_threshold Maximum intersection over the area of the smaller rectangle (0.5 by default)
+		inline void non_maximum_suppression(std::vector<cv::Rect> & rects, double const overlap_threshold = 0.5)
+		{
+			std::sort(rects.begin(), rects.end(), [](cv::Rect const & a, cv::Rect const & b) { return a.area() > b.area(); });
+			
+			std::size_t nb_kept = 0;
+			for (std::size_t i = 0; i < rects.size(); ++i)
+			{
+				bool overlap = false;
+				for (std::size_t j = 0; j < nb_kept && !overlap; ++j)
+				{
+					overlap = ((rects[i] & rects[j]).area() > overlap_threshold * rects[i].area());
+				}
+				if (!overlap) { rects[nb_kept++] = rects[i]; }
+			}
+			rects.resize(nb_kept);
+		}
+		
+		/**
+		 * @brief Cascade evaluated by all the cores on horizontal stripes of the image
+		 * 
+		 * @code
+			#include "vision/parallel_detection.hpp"
+		 * @endcode
+		 * 
+		 * The image is split into nb_stripe horizontal stripes which overlap by stripe_overlap rows;
+		 * in the stripes, the cascade looks for objects smaller than stripe_overlap only. @n
+		 * One more task scans the whole image for the objects bigger than stripe_overlap (few scales, few windows). @n
+		 * The tasks are shared by the OpenMP threads (schedule dynamic), then the detections are merged by
+		 * non-maximum suppression. @n
+		 * cv::CascadeClassifier is not thread-safe: each thread has its own copy of the cascade.
+		 */
+		class parallel_cascade
+		{
+		public:
+			
+			/// Number of stripes (0: 2 per OpenMP thread)
+			std::size_t nb_stripe = 0;
+			
+			/// Overlap of the stripes (in pixels) and limit between the small objects and the big objects (0: 1/4 of the height)
+			int stripe_overlap = 0;
+			
+			/// Maximum overlap of two detections of the same object (see gcar::vision::non_maximum_suppression)
+			double overlap_threshold = 0.5;
+			
+		private:
+			
+			/// One cascade per thread
+			std::vector<cv::CascadeClassifier> m_cascades;
+			
+			/// Detections of each task
+			std::vector<std::vector<cv::Rect>> m_detections;
+			
+		public:
+			
+			/// @brief Default constructor
+			parallel_cascade() : m_cascades(), m_detections()
+			{ }
+			
+			/// @brief Load the cascade (one copy per OpenMP thread)
+			/// @param[in] path Path of the cascade file
+			/// @return true if the cascade is loaded, false otherwise
+			bool load(std::string const & path)
+			{
+				m_cascades.resize(std::max(hnc::openmp::nb_thread_max(), std::size_t(1)));
+				for (auto & cascade : m_cascades)
+				{
+					if (!cascade.load(path)) { m_cascades.clear(); return false; }
+				}
+				return true;
+			}
+			
+			/// @brief Return true if the cascade is loaded
+			/// @return true if the cascade is loaded
+			bool is_loaded() const { return !m_cascades.empty(); }
+			
+			/// @brief Detect the objects
+			/// @param[in]  gray          Grayscale image
+			/// @param[out] detections    Detections
+			/// @param[in]  scale_factor  Scale factor of the cascade
+			/// @param[in]  min_neighbors Minimum neighbors of the cascade
+			/// @param[in]  min_size      Minimum size of an object
+			void detect
+			(
+				cv::Mat const & gray, std::vector<cv::Rect> & detections,
+				double const scale_factor, int const min_neighbors, cv::Size const min_size
+			)
+			{
+				detections.clear();
+				if (m_cascades.empty() || gray.empty()) { return; }
+				
+				std::size_t const nb_thread = m_cascades.size();
+				int const overlap = std::max((stripe_overlap > 0) ? stripe_overlap : gray.rows / 4, min_size.height + 1);
+				std::size_t const nb_task_stripe = std::max((nb_stripe > 0) ? nb_stripe : 2 * nb_thread, std::size_t(1));
+				int const stripe_height = (gray.rows + int(nb_task_stripe) - 1) / int(nb_task_stripe);
+				
+				// Stripes (small objects) + whole image (big objects)
+				std::size_t const nb_task = nb_task_stripe + 1;
+				m_detections.resize(nb_task);
+				
+				#pragma omp parallel for schedule(dynamic)
+				for (long int task = 0; task < long(nb_task); ++task)
+				{
+					cv::CascadeClassifier & cascade = m_cascades[hnc::openmp::thread_id() % nb_thread];
+					std::vector<cv::Rect> & task_detections = m_detections[std::size_t(task)];
+					
+					if (std::size_t(task) == nb_task_stripe)
+					{
+						cascade.detectMultiScale
+						(
+							gray, task_detections, scale_factor, min_neighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+							cv::Size(std::max(min_size.width, overlap * min_size.width / std::max(min_size.height, 1)), overlap)
+						);
+					}
+					else
+					{
+						int const begin = int(task) * stripe_height;
+						int const end = std::min(begin + stripe_height + overlap, gray.rows);
+						task_detections.clear();
+						if (begin < end)
+						{
+							cascade.detectMultiScale
+							(
+								gray.rowRange(begin, end), task_detections, scale_factor, min_neighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+								min_size, cv::Size(gray.cols, overlap)
+							);
+							for (auto & r : task_detections) { r.y += begin; }
+						}
+					}
+				}
+				
+				for (auto const & task_detections : m_detections)
+				{
+					detections.insert(detections.end(), task_detections.begin(), task_detections.end());
+				}
+				gcar::vision::non_maximum_suppression(detections, overlap_threshold);
+			}
+		};
+	}
+	
+}
+#endif
@@ -26,7 +26,10 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <type_traits>
 
+#include "../sfinae.hpp"
+#include "../unused.hpp"
 #include "../log_level.hpp"
 #include "../terminal.hpp"
 #include "../ostream_std.hpp"
@@ -96,6 +99,82 @@ namespace hnc
 				return o;
 			}
 
+			/**
+			 * @brief View on contiguous elements (parameters of evaluate_batch)
+			 *
+			 * @code
+			   #include <hnc/algo.hpp>
+			   @endcode
+			 */
+			template <class T>
+			class span_t
+			{
+			private:
+				
+				/// First element
+				T * m_data;
+				
+				/// Number of elements
+				std::size_t m_size;
+				
+			public:
+				
+				/// @brief Constructor
+				/// @param[in] data First element
+				/// @param[in] size Number of elements
+				span_t(T * const data, std::size_t const size) : m_data(data), m_size(size) { }
+				
+				/// @brief Return the first element
+				/// @return the first element
+				T * data() const { return m_data; }
+				
+				/// @brief Return the number of elements
+				/// @return the number of elements
+				std::size_t size() const { return m_size; }
+				
+				/// @brief Return true if there is no element
+				/// @return true if there is no element, false otherwise
+				bool empty() const { return m_size == 0; }
+				
+				/// @brief Return an element
+				/// @param[in] i Index
+				/// @return the element
+				T & operator [](std::size_t const i) const { return m_data[i]; }
+				
+				/// @brief Return an iterator on the first element
+				/// @return an iterator on the first element
+				T * begin() const { return m_data; }
+				
+				/// @brief Return an iterator after the last element
+				/// @return an iterator after the last element
+				T * end() const { return m_data + m_size; }
+			};
+			
+			/// @brief T has not the evaluate_batch member function
+			template <class T, class solution_t, class grade_t, class sfinae_valid_type = void>
+			class has_evaluate_batch : public std::false_type
+			{ };
+			
+			/// @brief T has the evaluate_batch(span_t<solution_t const>, span_t<grade_t>) member function
+			template <class T, class solution_t, class grade_t>
+			class has_evaluate_batch
+			<
+				T, solution_t, grade_t,
+				typename hnc::this_type
+				<
+					decltype
+					(
+						std::declval<T &>().evaluate_batch
+						(
+							std::declval<hnc::algo::genetic_algo::span_t<solution_t const>>(),
+							std::declval<hnc::algo::genetic_algo::span_t<grade_t>>()
+						)
+					)
+				>::is_valid
+			> :
+				public std::true_type
+			{ };
+			
 			/// Log levels
 			enum class log_level_t { no_log, minimal_log, minimal_plus_log, archipelago_log, island_log, solution_grade_log };
 			
@@ -106,7 +185,29 @@ namespace hnc
 			   #include <hnc/algo.hpp>
 			   @endcode
 			 * 
-			 * TODO
+			 * The population is split in archipelagos of islands of sorted solutions (the lower grade is the better). @n
+			 * T is an object with the member functions:
+			 * - solution_t generate_solution()
+			 * - grade_t evaluate_solution(solution_t const &)
+			 * - solution_t crossover(solution_t const &, solution_t const &)
+			 * - solution_t mutation(solution_t const &)
+			 * - bool stop(solution_t const &, grade_t const &)
+			 * 
+			 * T can have the member function
+			 * void evaluate_batch(span_t<solution_t const> solutions, span_t<grade_t> grades)
+			 * (detected at compile time, see hnc::algo::genetic_algo::has_evaluate_batch),
+			 * it is then used instead of evaluate_solution (which is not needed anymore):
+			 * the candidates of a generation are gathered and each thread evaluates its part in one call,
+			 * the setup of the evaluation is amortized and data-parallel kernels can be used. @n
+			 * 
+			 * T is copied for each thread. @n
+			 * Each archipelago × island pair is an independent OpenMP task (dynamic schedule),
+			 * so the cores are busy even with few islands per archipelago. @n
+			 * A generation has three steps: the offspring of all islands are created in a preallocated buffer,
+			 * then they are evaluated, then they are added after the parents in a preallocated island buffer
+			 * and the nb_solution_per_island bests are selected with std::nth_element. @n
+			 * Each thread keeps the best island it computed, the best solution is the best of these islands (no lock). @n
+			 * Migrations copy the bests of all islands first, then each island merges the migrants into its sorted solutions.
 			 */
 			template
 			<
@@ -116,15 +217,15 @@ namespace hnc
 			>
 			class genetic_algo
 			{
-			private:
+			protected:
 				
-				/// Number of thread (OpenMP)
+				/// Number of thread (OpenMP, 1 without OpenMP)
 				std::size_t const m_nb_thread;
 				
 				/// Object contains evolve functions
 				std::vector<T> m_evolve_functions;
 				
-				/// Solutions & grades
+				/// Solutions & grades (parents, then offspring during crossover_and_mutation)
 				std::vector
 				<
 					hnc::algo::genetic_algo::archipelago_t
@@ -136,6 +237,30 @@ namespace hnc
 					>
 				> m_solutions;
 				
+				/// Candidates of the generation (population or offspring), contiguous after gather_candidates
+				std::vector<solution_t> m_candidates;
+				
+				/// Grades of the candidates
+				std::vector<grade_t> m_candidate_grades;
+				
+				/// First candidate of each island
+				std::vector<std::size_t> m_candidate_first;
+				
+				/// Number of candidates of each island
+				std::vector<std::size_t> m_nb_candidate;
+				
+				/// Bests of each island during a migration
+				std::vector
+				<
+					hnc::algo::genetic_algo::island_t
+					<
+						hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>
+					>
+				> m_migrants;
+				
+				/// Best island (index in all islands) computed by each thread
+				std::vector<std::size_t> m_thread_best_island;
+				
 				/// Random probability for crossover and a mutation
 				std::vector<hnc::random::uniform_t<double>> m_random_probability;
 				
@@ -183,7 +308,7 @@ namespace hnc
 				/// Log level
 				log_level_t const log_level;
 				
-			private:
+			protected:
 				
 				/// Number of generations
 				std::size_t m_nb_generation;
@@ -234,7 +359,56 @@ namespace hnc
 					long double const max_time = 0.0,
 					log_level_t const log_level = hnc::algo::genetic_algo::log_level_t::no_log
 				) :
-					m_nb_thread(hnc::openmp::nb_thread_max()),
+					genetic_algo
+					(
+						no_evolve_t(),
+						evolve_functions,
+						nb_archipelago,
+						nb_island_per_archipelago,
+						nb_solution_per_island,
+						crossover_probability,
+						mutation_probability,
+						nb_migration_per_island,
+						nb_generation_between_island_migration,
+						nb_migration_per_archipelago,
+						nb_generation_between_archipelago_migration,
+						nb_same_solution_max,
+						nb_generation_max,
+						max_time,
+						log_level
+					)
+				{
+					evolve();
+				}
+				
+				/// @brief Destructor
+				virtual ~genetic_algo() { }
+				
+			protected:
+				
+				/// Tag of the constructor which does not evolve
+				class no_evolve_t { };
+				
+				/// @brief Constructor which generates the population but does not evolve (for derived classes)
+				genetic_algo
+				(
+					no_evolve_t const,
+					T const & evolve_functions,
+					std::size_t const nb_archipelago,
+					std::size_t const nb_island_per_archipelago,
+					std::size_t const nb_solution_per_island,
+					double const crossover_probability,
+					double const mutation_probability,
+					std::size_t const nb_migration_per_island,
+					std::size_t const nb_generation_between_island_migration,
+					std::size_t const nb_migration_per_archipelago,
+					std::size_t const nb_generation_between_archipelago_migration,
+					std::size_t const nb_same_solution_max,
+					std::size_t const nb_generation_max,
+					long double const max_time,
+					log_level_t const log_level
+				) :
+					m_nb_thread(std::max(hnc::openmp::nb_thread_max(), std::size_t(1))),
 					m_evolve_functions(m_nb_thread, evolve_functions),
 					m_solutions
 					(
@@ -257,8 +431,14 @@ namespace hnc
 							)
 						)
 					),
-					m_random_probability(m_nb_thread, hnc::random::uniform_t<double>(0., 1.)),
-					m_random_index(m_nb_thread, hnc::random::uniform_t<std::size_t>(0, nb_solution_per_island - 1)),
+					m_candidates(nb_archipelago * nb_island_per_archipelago * 2 * nb_solution_per_island),
+					m_candidate_grades(m_candidates.size()),
+					m_candidate_first(nb_archipelago * nb_island_per_archipelago, 0),
+					m_nb_candidate(nb_archipelago * nb_island_per_archipelago, 0),
+					m_migrants(nb_archipelago * nb_island_per_archipelago),
+					m_thread_best_island(m_nb_thread, 0),
+					m_random_probability(),
+					m_random_index(),
 					nb_archipelago(nb_archipelago),
 					nb_island_per_archipelago(nb_island_per_archipelago),
 					nb_solution_per_island(nb_solution_per_island),
@@ -282,44 +462,76 @@ namespace hnc
 					hnc::out(log_level, log_level_t::minimal_plus_log) << "  " << "(Max time                  = " << max_time << ")" << std::endl;
 					hnc::out(log_level, log_level_t::minimal_log) << "  " << "+ Generate the population" << std::endl;
 					
-					// Generate the population + distribution
-					for (std::size_t archipelago = 0; archipelago < m_solutions.size(); ++archipelago)
+					// One random stream per thread
+					for (std::size_t thread_id = 0; thread_id < m_nb_thread; ++thread_id)
 					{
-						hnc::out(log_level, log_level_t::archipelago_log) << "  " << "  " << "Archipelago " << archipelago << "/" << m_solutions.size() << std::endl;
+						long unsigned int const seed = (long unsigned int)(hnc::time::ns()) + 2 * thread_id;
+						m_random_probability.emplace_back(0., 1., seed);
+						m_random_index.emplace_back(0, nb_solution_per_island - 1, seed + 1);
+					}
+					
+					// Parents and offspring (at most one crossover and one mutation per parent) without reallocation
+					for (auto & archipelago : m_solutions)
+					{
+						for (auto & solutions : archipelago) { solutions.reserve(3 * nb_solution_per_island); }
+					}
+					for (auto & migrants : m_migrants)
+					{
+						migrants.reserve(std::max(nb_migration_per_island, nb_migration_per_archipelago));
+					}
+					
+					// Generate the population
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int k = 0; k < (long int)(nb_island()); ++k)
+					{
+						auto const thread_id = hnc::openmp::thread_id();
+						std::size_t const island_i = std::size_t(k);
+						
+						log_island(island_i);
 						
-						#pragma omp parallel for
-						for (std::size_t island = 0; island < m_solutions[archipelago].size(); ++island)
+						std::size_t const first = island_i * 2 * nb_solution_per_island;
+						for (std::size_t i = 0; i < nb_solution_per_island; ++i)
 						{
-							auto const thread_id = hnc::openmp::thread_id();
-							
-							hnc::out(log_level, log_level_t::island_log) << "  " << "  " << "  " << "Island " << island << "/" << m_solutions[archipelago].size() << std::endl;
-							
-							auto & solutions = m_solutions[archipelago][island];
-							
-							// Generate solution for island
-							for (auto & solution : solutions)
-							{
-								// Generate a solution
-								solution.solution = m_evolve_functions[thread_id].generate_solution();
-								// Evaluate the solution
-								solution.grade = m_evolve_functions[thread_id].evaluate_solution(solution.solution);
-							}
-							
-							std::sort(solutions.begin(), solutions.end());
-							
-							for (auto & solution : solutions)
-							{
-								hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Solution: " << solution << std::endl;
-							}
+							m_candidates[first + i] = m_evolve_functions[thread_id].generate_solution();
 						}
+						m_nb_candidate[island_i] = nb_solution_per_island;
 					}
 					
-					find_best_solution();
+					// Evaluate the population
+					evaluate_candidates();
 					
-					// Evolve
-					evolve();
+					// Distribution
+					reset_thread_best_island();
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int k = 0; k < (long int)(nb_island()); ++k)
+					{
+						auto const thread_id = hnc::openmp::thread_id();
+						std::size_t const island_i = std::size_t(k);
+						
+						auto & solutions = island(island_i);
+						
+						std::size_t const first = m_candidate_first[island_i];
+						for (std::size_t i = 0; i < nb_solution_per_island; ++i)
+						{
+							solutions[i].solution = std::move(m_candidates[first + i]);
+							solutions[i].grade = m_candidate_grades[first + i];
+						}
+						
+						std::sort(solutions.begin(), solutions.end());
+						
+						for (auto & solution : solutions)
+						{
+							hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Solution: " << solution << std::endl;
+						}
+						
+						update_thread_best_island(thread_id, island_i);
+					}
+					
+					find_best_solution();
 				}
 				
+			public:
+				
 				/// @brief Return the number of generations
 				/// @return the number of generations
 				std::size_t nb_generation() const { return m_nb_generation; }
@@ -336,15 +548,52 @@ namespace hnc
 				/// @return the actual best solution
 				hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t> const & best_solution() const { return m_best_solution.get(); }
 				
-			private:
+			protected:
 				
-				/// @brief Solve the problem
-				void evolve()
+				/// @brief Return the number of islands (all archipelagos)
+				/// @return the number of islands
+				std::size_t nb_island() const { return nb_archipelago * nb_island_per_archipelago; }
+				
+				/// @brief Return an island
+				/// @param[in] island_i Index of the island in all islands (archipelago * nb_island_per_archipelago + island)
+				/// @return the island
+				hnc::algo::genetic_algo::island_t<hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>> & island(std::size_t const island_i)
 				{
-					hnc::out(log_level, log_level_t::minimal_log) << "Evolve genetic algorithm" << std::endl;
-					
-					while
-					(
+					return m_solutions[island_i / nb_island_per_archipelago][island_i % nb_island_per_archipelago];
+				}
+				
+				/// @brief Log the start of an island task
+				/// @param[in] island_i Index of the island in all islands
+				void log_island(std::size_t const island_i) const
+				{
+					hnc::out(log_level, log_level_t::island_log)
+						<< "  " << "  " << "Archipelago " << island_i / nb_island_per_archipelago << "/" << nb_archipelago
+						<< " - Island " << island_i % nb_island_per_archipelago << "/" << nb_island_per_archipelago << std::endl;
+				}
+				
+				/// @brief Forget the best islands of the threads (before a parallel loop on all islands)
+				void reset_thread_best_island()
+				{
+					std::fill(m_thread_best_island.begin(), m_thread_best_island.end(), nb_island());
+				}
+				
+				/// @brief Update the best island of a thread (the thread has computed this island)
+				/// @param[in] thread_id Thread id
+				/// @param[in] island_i  Index of the island in all islands
+				void update_thread_best_island(std::size_t const thread_id, std::size_t const island_i)
+				{
+					std::size_t & best_island = m_thread_best_island[thread_id];
+					if (best_island == nb_island() || island(island_i)[0].grade < island(best_island)[0].grade)
+					{
+						best_island = island_i;
+					}
+				}
+				
+				/// @brief Return true if the stop criteria are not reached
+				/// @return true if the algorithm must continue, false otherwise
+				virtual bool must_continue()
+				{
+					return
 						// Number of generations
 						(nb_generation_max == 0 || nb_generation() <= nb_generation_max) &&
 						// Time
@@ -352,8 +601,15 @@ namespace hnc
 						// The best solution is the same
 						(nb_same_solution_max == 0 || nb_same_solution() <= nb_same_solution_max) &&
 						// User continue
-						! m_evolve_functions[0].stop(best_solution().solution, best_solution().grade)
-					)
+						! m_evolve_functions[0].stop(best_solution().solution, best_solution().grade);
+				}
+				
+				/// @brief Solve the problem
+				void evolve()
+				{
+					hnc::out(log_level, log_level_t::minimal_log) << "Evolve genetic algorithm" << std::endl;
+					
+					while (must_continue())
 					{
 						hnc::out(log_level, log_level_t::minimal_log) << "  " << "Generation " << nb_generation() << " / " << nb_generation_max << " - Best solution = " << best_solution();
 						if (log_level == log_level_t::minimal_log) { std::cout.flush(); }
@@ -398,146 +654,245 @@ namespace hnc
 				{
 					hnc::out(log_level, log_level_t::minimal_plus_log) << "  " << "+ Crossover & mutation" << std::endl;
 					
-					// Do crossover and mutation
-					for (std::size_t archipelago = 0; archipelago < m_solutions.size(); ++archipelago)
+					// Offspring of each island
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int k = 0; k < (long int)(nb_island()); ++k)
 					{
-						hnc::out(log_level, log_level_t::archipelago_log) << "  " << "  " << "Archipelago " << archipelago << "/" << m_solutions.size() << std::endl;
+						auto const thread_id = hnc::openmp::thread_id();
+						std::size_t const island_i = std::size_t(k);
+						
+						log_island(island_i);
+						
+						auto const & solutions = island(island_i);
+						
+						std::size_t const first = island_i * 2 * nb_solution_per_island;
+						std::size_t nb_offspring = 0;
 						
-						#pragma omp parallel for
-						for (std::size_t island = 0; island < m_solutions[archipelago].size(); ++island)
+						// Crossover and mutation of the parents
+						for (std::size_t i = 0; i < solutions.size(); ++i)
 						{
-							auto const thread_id = hnc::openmp::thread_id();
-							
-							hnc::out(log_level, log_level_t::island_log) << "  " << "  " << "  " << "Island " << island << "/" << m_solutions[archipelago].size() << std::endl;
-							
-							auto & solutions = m_solutions[archipelago][island];
-							
-							std::size_t const nb_solution = solutions.size();
-							
-							// Crossover and mutation
-							for (std::size_t i = 0; i < nb_solution; ++i)
+							// Crossover
+							if (m_random_probability[thread_id]() <= crossover_probability)
 							{
-								// Crossover
-								if (m_random_probability[thread_id]() <= crossover_probability)
-								{
-									auto const random_solution_i = m_random_index[thread_id]();
-									
-									if (i != random_solution_i)
-									{
-										auto const & random_solution = solutions[random_solution_i];
-										
-										auto const new_solution = m_evolve_functions[thread_id].crossover
-										(
-											solutions[i].solution,
-											random_solution.solution
-										);
-										
-										hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Crossover: " << solutions[i] << " + " << random_solution << " -> " << solutions.back() << std::endl;
-										
-										solutions.emplace_back
-										(
-											new_solution,
-											m_evolve_functions[thread_id].evaluate_solution(new_solution)
-										);
-									}
-								}
+								auto const random_solution_i = m_random_index[thread_id]();
 								
-								// Mutation
-								if (m_random_probability[thread_id]() <= mutation_probability)
+								if (i != random_solution_i)
 								{
-									auto const new_solution = m_evolve_functions[thread_id].mutation(solutions[i].solution);
-									
-									hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Mutation:  " << solutions[i] << " -> " << solutions.back() << std::endl;
+									auto const & random_solution = solutions[random_solution_i];
 									
-									solutions.emplace_back
+									auto & new_solution = m_candidates[first + nb_offspring++];
+									new_solution = m_evolve_functions[thread_id].crossover
 									(
-										new_solution,
-										m_evolve_functions[thread_id].evaluate_solution(new_solution)
+										solutions[i].solution,
+										random_solution.solution
 									);
+									
+									hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Crossover: " << solutions[i] << " + " << random_solution << " -> " << new_solution << std::endl;
 								}
 							}
 							
-							std::sort(solutions.begin(), solutions.end());
-							
-							solutions.resize(nb_solution);
-							
-							for (auto & solution : solutions)
+							// Mutation
+							if (m_random_probability[thread_id]() <= mutation_probability)
 							{
-								hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Solution:  " << solution << std::endl;
+								auto & new_solution = m_candidates[first + nb_offspring++];
+								new_solution = m_evolve_functions[thread_id].mutation(solutions[i].solution);
+								
+								hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Mutation:  " << solutions[i] << " -> " << new_solution << std::endl;
 							}
 						}
+						
+						m_nb_candidate[island_i] = nb_offspring;
+					}
+					
+					// Evaluate the offspring of all islands
+					evaluate_candidates();
+					
+					// Selection of the nb_solution_per_island bests of parents and offspring
+					reset_thread_best_island();
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int k = 0; k < (long int)(nb_island()); ++k)
+					{
+						auto const thread_id = hnc::openmp::thread_id();
+						std::size_t const island_i = std::size_t(k);
+						
+						auto & solutions = island(island_i);
+						
+						// The offspring are added after the parents
+						std::size_t const first = m_candidate_first[island_i];
+						for (std::size_t i = 0; i < m_nb_candidate[island_i]; ++i)
+						{
+							solutions.emplace_back(std::move(m_candidates[first + i]), m_candidate_grades[first + i]);
+						}
+						
+						if (solutions.size() > nb_solution_per_island)
+						{
+							std::nth_element(solutions.begin(), solutions.begin() + std::ptrdiff_t(nb_solution_per_island), solutions.end());
+							solutions.erase(solutions.begin() + std::ptrdiff_t(nb_solution_per_island), solutions.end());
+							std::sort(solutions.begin(), solutions.end());
+						}
+						
+						for (auto & solution : solutions)
+						{
+							hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << "Solution:  " << solution << std::endl;
+						}
+						
+						update_thread_best_island(thread_id, island_i);
 					}
 					
 					find_best_solution();
 				}
+				
+				/// @brief Gather the candidates of the islands (contiguous) and evaluate them
+				void evaluate_candidates()
+				{
+					// Island i has written its candidates from i * 2 * nb_solution_per_island
+					std::size_t nb_candidate = 0;
+					for (std::size_t island_i = 0; island_i < nb_island(); ++island_i)
+					{
+						std::size_t const first = island_i * 2 * nb_solution_per_island;
+						if (first != nb_candidate)
+						{
+							std::move
+							(
+								m_candidates.begin() + std::ptrdiff_t(first),
+								m_candidates.begin() + std::ptrdiff_t(first + m_nb_candidate[island_i]),
+								m_candidates.begin() + std::ptrdiff_t(nb_candidate)
+							);
+						}
+						m_candidate_first[island_i] = nb_candidate;
+						nb_candidate += m_nb_candidate[island_i];
+					}
+					
+					evaluate_candidates(nb_candidate, hnc::algo::genetic_algo::has_evaluate_batch<T, solution_t, grade_t>());
+				}
+				
+				/// @brief Evaluate the candidates with evaluate_batch (one call per thread)
+				/// @param[in] nb_candidate Number of candidates
+				/// @param[in] tag          std::true_type
+				void evaluate_candidates(std::size_t const nb_candidate, std::true_type const tag)
+				{
+					hnc_unused(tag);
+					
+					std::size_t const nb_candidate_per_thread = (nb_candidate + m_nb_thread - 1) / m_nb_thread;
+					
+					#pragma omp parallel for
+					for (long int part = 0; part < (long int)(m_nb_thread); ++part)
+					{
+						std::size_t const first = std::size_t(part) * nb_candidate_per_thread;
+						if (first >= nb_candidate) { continue; }
+						std::size_t const size = std::min(nb_candidate_per_thread, nb_candidate - first);
+						
+						m_evolve_functions[hnc::openmp::thread_id()].evaluate_batch
+						(
+							hnc::algo::genetic_algo::span_t<solution_t const>(m_candidates.data() + first, size),
+							hnc::algo::genetic_algo::span_t<grade_t>(m_candidate_grades.data() + first, size)
+						);
+					}
+				}
+				
+				/// @brief Evaluate the candidates with evaluate_solution
+				/// @param[in] nb_candidate Number of candidates
+				/// @param[in] tag          std::false_type
+				void evaluate_candidates(std::size_t const nb_candidate, std::false_type const tag)
+				{
+					hnc_unused(tag);
+					
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int i = 0; i < (long int)(nb_candidate); ++i)
+					{
+						m_candidate_grades[std::size_t(i)] = m_evolve_functions[hnc::openmp::thread_id()].evaluate_solution(m_candidates[std::size_t(i)]);
+					}
+				}
+				
+				/// @brief Replace the worst solutions of an island by the migrants (the island stays sorted)
+				/// @param[in,out] solutions Sorted solutions of the island
+				/// @param[in]     migrants  Sorted migrants
+				void immigration
+				(
+					hnc::algo::genetic_algo::island_t<hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>> & solutions,
+					hnc::algo::genetic_algo::island_t<hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>> const & migrants
+				) const
+				{
+					auto const worst_first = solutions.end() - std::ptrdiff_t(migrants.size());
+					for (std::size_t i = 0; i < migrants.size(); ++i)
+					{
+						auto & worst_solution = *(solutions.end() - 1 - std::ptrdiff_t(i));
+						hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << worst_solution << " <- " << migrants[i] << std::endl;
+					}
+					std::copy(migrants.begin(), migrants.end(), worst_first);
+					std::inplace_merge(solutions.begin(), worst_first, solutions.end());
+				}
 
 				/// @brief Migration between islands
 				void migration_between_islands()
 				{
 					hnc::out(log_level, log_level_t::minimal_plus_log) << "  " << "+ Migration between islands" << std::endl;
 					
-					for (auto & archipelago : m_solutions)
+					// Copy the x bests of each island
+					#pragma omp parallel for
+					for (long int i = 0; i < (long int)(nb_island()); ++i)
+					{
+						auto const & solutions = island(std::size_t(i));
+						m_migrants[std::size_t(i)].assign(solutions.begin(), solutions.begin() + std::ptrdiff_t(nb_migration_per_island));
+					}
+					
+					// Replace x worst solutions by the x bests of the previous island
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (long int i = 0; i < (long int)(nb_island()); ++i)
 					{
-						hnc::out(log_level, log_level_t::archipelago_log) << "  " << "  " << "Archipelago" << std::endl;
+						std::size_t const island_i = std::size_t(i);
 						
-						for (std::size_t island = 0; island < archipelago.size(); ++island)
-						{
-							hnc::out(log_level, log_level_t::island_log) << "  " << "  " << "  " << "Island " << island << "/" << archipelago.size() << std::endl;
-							
-							// Get previous island index
-							std::size_t previous_island = (island == 0) ? (archipelago.size() - 1) : (island - 1);
-							// Replace x worst solutions by the x bests
-							for (std::size_t i = 0; i < nb_migration_per_island; ++i)
-							{
-								auto & worst_solution = archipelago[island][archipelago[island].size() - 1 - i];
-								auto & best_solution = archipelago[previous_island][i];
-								hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << worst_solution << " <- " << best_solution << std::endl;
-								worst_solution = best_solution;
-							}
-							std::sort(archipelago[island].begin(), archipelago[island].end());
-						}
+						log_island(island_i);
+						
+						// Get previous island index
+						std::size_t const archipelago_first = island_i - island_i % nb_island_per_archipelago;
+						std::size_t const previous_island = (island_i == archipelago_first) ? (archipelago_first + nb_island_per_archipelago - 1) : (island_i - 1);
+						
+						immigration(island(island_i), m_migrants[previous_island]);
 					}
 				}
 				
 				/// @brief Migration between archipelagos
-				void migration_between_archipelagos()
+				virtual void migration_between_archipelagos()
 				{
 					hnc::out(log_level, log_level_t::minimal_plus_log) << "  " << "+ Migration between archipelagos" << std::endl;
 					
+					// Copy the x bests of the first island of each archipelago
 					for (std::size_t archipelago = 0; archipelago < m_solutions.size(); ++archipelago)
 					{
+						auto const & solutions = m_solutions[archipelago][0];
+						m_migrants[archipelago].assign(solutions.begin(), solutions.begin() + std::ptrdiff_t(nb_migration_per_archipelago));
+					}
+					
+					// Replace x worst solutions by the x bests of the previous archipelago
+					#pragma omp parallel for
+					for (long int i = 0; i < (long int)(m_solutions.size()); ++i)
+					{
+						std::size_t const archipelago = std::size_t(i);
+						
 						hnc::out(log_level, log_level_t::archipelago_log) << "  " << "  " << "Archipelago " << archipelago << "/" << m_solutions.size() << std::endl;
-							
+						
 						// Get previous archipelago index
-						std::size_t previous_archipelago = (archipelago == 0) ? (m_solutions.size() - 1) : (archipelago - 1);
-						// Replace x worst solutions by the x bests
-						for (std::size_t i = 0; i < nb_migration_per_archipelago; ++i)
-						{
-							auto & worst_solution = m_solutions[archipelago][0][m_solutions[archipelago][0].size() - 1 - i];
-							auto & best_solution = m_solutions[previous_archipelago][0][i];
-							hnc::out(log_level, log_level_t::solution_grade_log) << "  " << "  " << "  " << "  " << worst_solution << " <- " << best_solution << std::endl;
-							worst_solution = best_solution;
-						}
-						std::sort(m_solutions[archipelago][0].begin(), m_solutions[archipelago][0].end());
+						std::size_t const previous_archipelago = (archipelago == 0) ? (m_solutions.size() - 1) : (archipelago - 1);
+						
+						immigration(m_solutions[archipelago][0], m_migrants[previous_archipelago]);
 					}
 				}
 				
-				/// @brief Update best solution
-				void find_best_solution()
+				/// @brief Update best solution from the best islands of the threads
+				virtual void find_best_solution()
 				{
-					m_best_solution = std::cref(m_solutions[0][0][0]); // TODO Use std::reference_wrapper
+					m_best_solution = std::cref(m_solutions[0][0][0]);
 					
-					for (auto const & archipelago : m_solutions)
+					for (std::size_t const best_island : m_thread_best_island)
 					{
-						for (auto const & island : archipelago)
+						if (best_island == nb_island()) { continue; }
+						
+						auto const & solution = island(best_island)[0];
+						
+						if (solution.grade < m_best_solution.get().grade)
 						{
-							auto const & solution = island[0];
-							
-							if (solution.grade < m_best_solution.get().grade)
-							{
-								m_best_solution = std::cref(solution);
-							}
-							
+							m_best_solution = std::cref(solution);
 						}
 					}
 				}
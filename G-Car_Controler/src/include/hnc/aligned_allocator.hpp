@@ -0,0 +1,109 @@
+// Copyright © 2012-2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HNC_ALIGNED_ALLOCATOR_HPP
+#define HNC_ALIGNED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <limits>
+
+
+namespace hnc
+{
+	/**
+	 * @brief Allocator whose memory blocks start on a multiple of alignment bytes
+	 *
+	 * @code
+	   #include <hnc/aligned_allocator.hpp>
+	   @endcode
+	 *
+	 * For example, with alignment = 64, a std::vector<float, hnc::aligned_allocator<float, 64>>
+	 * starts on a cache line (and on a SIMD register boundary)
+	 *
+	 * @pre alignment is a power of 2
+	 */
+	template <class T, std::size_t alignment>
+	class aligned_allocator
+	{
+		static_assert((alignment & (alignment - 1)) == 0, "hnc::aligned_allocator: alignment must be a power of 2");
+		
+	public:
+		
+		/// Type of the elements
+		using value_type = T;
+		
+		/// Same allocator for an other type
+		template <class U>
+		class rebind
+		{
+		public:
+			
+			/// Allocator
+			using other = hnc::aligned_allocator<U, alignment>;
+		};
+		
+		/// @brief Default constructor
+		aligned_allocator() = default;
+		
+		/// @brief Constructor from an other type
+		template <class U>
+		aligned_allocator(hnc::aligned_allocator<U, alignment> const &)
+		{ }
+		
+		/// @brief Allocate n elements
+		/// @param[in] n Number of elements
+		/// @exception std::bad_alloc if the allocation fails
+		/// @return a pointer aligned on alignment bytes
+		T * allocate(std::size_t const n)
+		{
+			if (n > (std::numeric_limits<std::size_t>::max() - alignment - sizeof(void *)) / sizeof(T))
+			{
+				throw std::bad_alloc();
+			}
+			
+			// Allocate more, align and save the original pointer just before the aligned block
+			char * const raw = static_cast<char *>(::operator new(n * sizeof(T) + alignment + sizeof(void *)));
+			std::uintptr_t const begin = reinterpret_cast<std::uintptr_t>(raw + sizeof(void *));
+			char * const aligned = reinterpret_cast<char *>((begin + alignment - 1) & ~std::uintptr_t(alignment - 1));
+			reinterpret_cast<void * *>(aligned)[-1] = raw;
+			return reinterpret_cast<T *>(aligned);
+		}
+		
+		/// @brief Free a block
+		/// @param[in] p Pointer returned by allocate
+		void deallocate(T * const p, std::size_t const)
+		{
+			if (p != nullptr) { ::operator delete(reinterpret_cast<void * *>(p)[-1]); }
+		}
+	};
+	
+	/// @brief Equality operator (all hnc::aligned_allocator are equal)
+	template <class T, class U, std::size_t alignment>
+	bool operator ==(hnc::aligned_allocator<T, alignment> const &, hnc::aligned_allocator<U, alignment> const &)
+	{
+		return true;
+	}
+	
+	/// @brief Inequality operator (all hnc::aligned_allocator are equal)
+	template <class T, class U, std::size_t alignment>
+	bool operator !=(hnc::aligned_allocator<T, alignment> const &, hnc::aligned_allocator<U, alignment> const &)
+	{
+		return false;
+	}
+}
+
+#endif
@@ -158,14 +158,14 @@ namespace hnc
 		{
 			auto const & key = t.first;
 			auto const & value = t.second;
-			std::cout << key << ":" << "\n";
-			std::cout << "- all:            " << hnc::ostreamable(value.all) << "\n";
-			std::cout << "- min:            " << value.min() << "\n";
-			std::cout << "- max:            " << value.max() << "\n";
-			std::cout << "- median:         " << value.median() << "\n";
-			std::cout << "- geometric mean: " << value.geometric_mean() << "\n";
-			std::cout << "- mean:           " << value.mean();
-			if (t.first != b.rbegin()->first) { std::cout << "\n"; }
+			o << key << ":" << "\n";
+			o << "- all:            " << hnc::ostreamable(value.all) << "\n";
+			o << "- min:            " << value.min() << "\n";
+			o << "- max:            " << value.max() << "\n";
+			o << "- median:         " << value.median() << "\n";
+			o << "- geometric mean: " << value.geometric_mean() << "\n";
+			o << "- mean:           " << value.mean();
+			if (t.first != b.rbegin()->first) { o << "\n"; }
 		}
 		return o;
 	}
@@ -181,7 +181,33 @@ namespace hnc
 	 * 
 	 * @return a std::map of double, key is the name of the benchmark, value is the mean
 	 */
-	std::map<std::string, long double> benchmark_extract_mean(hnc::benchmark const & b)
+	inline std::map<std::string, long double> benchmark_extract_mean(hnc::benchmark const & b)
+	{
+		std::map<std::string, long double> r;
+		
+		for (auto const & t : b)
+		{
+			auto const & key = t.first;
+			auto const & value = t.second;
+			
+			r[key] = value.mean();
+		}
+
+		return r;
+	}
+	
+	/**
+	 * @brief Return a std::map of double, key is the name of the benchmark, value is the median
+	 * 
+	 * @code
+	   #include <hnc/benchmark.hpp>
+	   @endcode
+	 *
+	 * @param[in] b hnc::benchmark
+	 * 
+	 * @return a std::map of double, key is the name of the benchmark, value is the median
+	 */
+	inline std::map<std::string, long double> benchmark_extract_median(hnc::benchmark const & b)
 	{
 		std::map<std::string, long double> r;
 		
@@ -0,0 +1,544 @@
+// Copyright © 2012-2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HNC_BENCHMARK_RUNNER_HPP
+#define HNC_BENCHMARK_RUNNER_HPP
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#if defined(__linux__)
+	#include <unistd.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <linux/perf_event.h>
+#endif
+
+#include "benchmark.hpp"
+
+
+namespace hnc
+{
+	/**
+	 * @brief Prevent the compiler from removing a computation whose result is not used
+	 *
+	 * @code
+	   #include <hnc/benchmark_runner.hpp>
+	   @endcode
+	 *
+	 * @param[in] value Result of the computation
+	 */
+	template <class T>
+	inline void do_not_optimize(T const & value)
+	{
+		#if defined(__GNUC__)
+			asm volatile("" : : "g"(&value) : "memory");
+		#else
+			static T const * volatile p = nullptr;
+			p = &value;
+		#endif
+	}
+	
+	/**
+	 * @brief Hardware counters of the calling thread (cycles, instructions, cache misses) with perf_event_open
+	 *
+	 * @code
+	   #include <hnc/benchmark_runner.hpp>
+	   @endcode
+	 *
+	 * Only on Linux; is_available() is false elsewhere or when the kernel refuses (see /proc/sys/kernel/perf_event_paranoid).
+	 */
+	class perf_counters
+	{
+	public:
+		
+		/// Values of the counters
+		class values_t
+		{
+		public:
+			
+			/// CPU cycles
+			double cycles = 0;
+			
+			/// Instructions
+			double instructions = 0;
+			
+			/// Cache misses
+			double cache_misses = 0;
+		};
+		
+	private:
+		
+		/// File descriptors (cycles is the group leader), -1 if not opened
+		int m_fd[3];
+		
+	public:
+		
+		/// @brief Constructor, open the counters
+		perf_counters() : m_fd{ -1, -1, -1 }
+		{
+			#if defined(__linux__)
+				std::uint64_t const configs[3] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+				for (std::size_t i = 0; i < 3; ++i)
+				{
+					perf_event_attr attr;
+					std::memset(&attr, 0, sizeof(attr));
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.size = sizeof(attr);
+					attr.config = configs[i];
+					attr.disabled = (i == 0) ? 1 : 0;
+					attr.exclude_kernel = 1;
+					attr.exclude_hv = 1;
+					attr.read_format = PERF_FORMAT_GROUP;
+					m_fd[i] = int(syscall(__NR_perf_event_open, &attr, 0, -1, m_fd[0], 0));
+					if (m_fd[i] < 0) { close_all(); return; }
+				}
+			#endif
+		}
+		
+		/// @brief Copy constructor (deleted)
+		perf_counters(perf_counters const &) = delete;
+		
+		/// @brief Copy assignment (deleted)
+		perf_counters & operator =(perf_counters const &) = delete;
+		
+		/// @brief Destructor, close the counters
+		~perf_counters() { close_all(); }
+		
+		/// @brief Return true if the counters are available
+		/// @return true if the counters are available, false otherwise
+		bool is_available() const { return m_fd[0] >= 0; }
+		
+		/// @brief Reset and start the counters
+		void start()
+		{
+			#if defined(__linux__)
+				if (is_available() == false) { return; }
+				ioctl(m_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(m_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			#endif
+		}
+		
+		/// @brief Stop the counters and return their values
+		/// @return the values of the counters since start (0 if not available)
+		values_t stop()
+		{
+			values_t values;
+			#if defined(__linux__)
+				if (is_available() == false) { return values; }
+				ioctl(m_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+				// nr, then one value per counter
+				std::uint64_t buffer[4] = { 0, 0, 0, 0 };
+				if (read(m_fd[0], buffer, sizeof(buffer)) == ssize_t(sizeof(buffer)) && buffer[0] == 3)
+				{
+					values.cycles = double(buffer[1]);
+					values.instructions = double(buffer[2]);
+					values.cache_misses = double(buffer[3]);
+				}
+			#endif
+			return values;
+		}
+		
+	private:
+		
+		/// @brief Close the counters
+		void close_all()
+		{
+			#if defined(__linux__)
+				for (int & fd : m_fd)
+				{
+					if (fd >= 0) { close(fd); }
+					fd = -1;
+				}
+			#endif
+		}
+	};
+	
+	/**
+	 * @brief Options of hnc::benchmark_runner
+	 *
+	 * @code
+	   #include <hnc/benchmark_runner.hpp>
+	   @endcode
+	 */
+	class benchmark_options
+	{
+	public:
+		
+		/// Number of samples executed and ignored before the measures
+		std::size_t nb_warmup = 3;
+		
+		/// Number of samples measured
+		std::size_t nb_sample = 30;
+		
+		/// Minimum duration of a sample (in seconds), the number of iterations per sample is calibrated to reach it
+		double min_sample_time = 0.01;
+		
+		/// Maximum number of iterations per sample
+		std::size_t max_nb_iteration = std::size_t(1) << 30;
+		
+		/// Remove the samples outside [Q1 - 1.5 IQR, Q3 + 1.5 IQR]
+		bool reject_outliers = true;
+		
+		/// Number of bootstrap resamples for the confidence interval
+		std::size_t nb_resample = 2000;
+		
+		/// Confidence level of the interval (0.95 by default)
+		double confidence = 0.95;
+		
+		/// Read the hardware counters (hnc::perf_counters)
+		bool use_perf_counters = false;
+		
+		/// Seed of the bootstrap
+		std::uint64_t seed = 42;
+	};
+	
+	/**
+	 * @brief Result of a benchmark of hnc::benchmark_runner (times in seconds per iteration)
+	 *
+	 * @code
+	   #include <hnc/benchmark_runner.hpp>
+	   @endcode
+	 */
+	class benchmark_result
+	{
+	public:
+		
+		/// Name
+		std::string name;
+		
+		/// Number of iterations per sample
+		std::size_t nb_iteration = 0;
+		
+		/// Time per iteration of each sample kept
+		std::vector<double> samples;
+		
+		/// Number of samples removed as outliers
+		std::size_t nb_outlier = 0;
+		
+		/// Minimum
+		double min = 0;
+		
+		/// Maximum
+		double max = 0;
+		
+		/// Median
+		double median = 0;
+		
+		/// Mean
+		double mean = 0;
+		
+		/// Standard deviation
+		double standard_deviation = 0;
+		
+		/// Lower bound of the confidence interval of the median (bootstrap)
+		double median_low = 0;
+		
+		/// Upper bound of the confidence interval of the median (bootstrap)
+		double median_high = 0;
+		
+		/// CPU cycles per iteration (< 0 if not measured)
+		double cycles = -1;
+		
+		/// Instructions per iteration (< 0 if not measured)
+		double instructions = -1;
+		
+		/// Cache misses per iteration (< 0 if not measured)
+		double cache_misses = -1;
+	};
+	
+	/**
+	 * @brief Benchmark harness: warm-up, calibrated iteration counts, outlier rejection, bootstrap confidence interval and hardware counters
+	 *
+	 * @code
+	   #include <hnc/benchmark_runner.hpp>
+	   @endcode
+	 *
+	 * For each benchmark:
+	 * 1. the number of iterations per sample is doubled until a sample lasts min_sample_time
+	 * 2. nb_warmup samples are executed and ignored
+	 * 3. nb_sample samples are measured (time per iteration, and hardware counters if asked)
+	 * 4. the outliers are removed (Tukey fences), then the statistics and the bootstrap confidence interval of the median are computed
+	 *
+	 * The results can be exported in JSON or CSV to follow regressions between versions.
+	 *
+	 * @code
+	   hnc::benchmark_runner runner;
+	   runner.options.use_perf_counters = true;
+	   runner.run("bgr_to_rgba 640x480", [&]() { gcar::video::bgr_to_rgba(bgr.data(), rgba.data(), 640 * 480); });
+	   runner.run("decode telemetry", [&]() { hnc::do_not_optimize(gcar::network::decode(buffer)); });
+	   std::cout << runner << std::endl;
+	   std::ofstream json("bench.json");
+	   runner.to_json(json);
+	   @endcode
+	 */
+	class benchmark_runner
+	{
+	public:
+		
+		/// Options (used by the next run)
+		hnc::benchmark_options options;
+		
+	private:
+		
+		/// Results
+		std::vector<hnc::benchmark_result> m_results;
+		
+	public:
+		
+		/// @brief Constructor
+		/// @param[in] options Options
+		benchmark_runner(hnc::benchmark_options const & options = hnc::benchmark_options()) :
+			options(options), m_results()
+		{ }
+		
+		/**
+		 * @brief Benchmark a function
+		 * @param[in] name Name of the benchmark
+		 * @param[in] f    Function without parameter (one iteration)
+		 * @return the result
+		 */
+		template <class function_t>
+		hnc::benchmark_result const & run(std::string const & name, function_t f)
+		{
+			hnc::benchmark_result result;
+			result.name = name;
+			
+			// Calibration
+			result.nb_iteration = 1;
+			while (result.nb_iteration < options.max_nb_iteration && time_sample(f, result.nb_iteration) < options.min_sample_time)
+			{
+				result.nb_iteration *= 2;
+			}
+			
+			// Warm-up
+			for (std::size_t i = 0; i < options.nb_warmup; ++i) { time_sample(f, result.nb_iteration); }
+			
+			// Samples
+			hnc::perf_counters counters_opened;
+			hnc::perf_counters * const counters = (options.use_perf_counters && counters_opened.is_available()) ? &counters_opened : nullptr;
+			hnc::perf_counters::values_t counters_sum;
+			for (std::size_t i = 0; i < std::max(options.nb_sample, std::size_t(1)); ++i)
+			{
+				if (counters != nullptr) { counters->start(); }
+				double const time = time_sample(f, result.nb_iteration);
+				if (counters != nullptr)
+				{
+					hnc::perf_counters::values_t const values = counters->stop();
+					counters_sum.cycles += values.cycles;
+					counters_sum.instructions += values.instructions;
+					counters_sum.cache_misses += values.cache_misses;
+				}
+				result.samples.push_back(time / double(result.nb_iteration));
+			}
+			if (counters != nullptr)
+			{
+				double const nb = double(result.samples.size()) * double(result.nb_iteration);
+				result.cycles = counters_sum.cycles / nb;
+				result.instructions = counters_sum.instructions / nb;
+				result.cache_misses = counters_sum.cache_misses / nb;
+			}
+			
+			// Outliers
+			std::sort(result.samples.begin(), result.samples.end());
+			if (options.reject_outliers && result.samples.size() >= 4)
+			{
+				double const q1 = quantile(result.samples, 0.25);
+				double const q3 = quantile(result.samples, 0.75);
+				double const low = q1 - 1.5 * (q3 - q1);
+				double const high = q3 + 1.5 * (q3 - q1);
+				std::size_t const size = result.samples.size();
+				result.samples.erase
+				(
+					std::remove_if(result.samples.begin(), result.samples.end(), [&](double const t) { return t < low || t > high; }),
+					result.samples.end()
+				);
+				result.nb_outlier = size - result.samples.size();
+			}
+			
+			// Statistics
+			std::vector<double> const & samples = result.samples;
+			result.min = samples.front();
+			result.max = samples.back();
+			result.median = quantile(samples, 0.5);
+			double sum = 0;
+			for (double const t : samples) { sum += t; }
+			result.mean = sum / double(samples.size());
+			double sum_square = 0;
+			for (double const t : samples) { sum_square += (t - result.mean) * (t - result.mean); }
+			result.standard_deviation = (samples.size() > 1) ? std::sqrt(sum_square / double(samples.size() - 1)) : 0;
+			
+			// Bootstrap of the median
+			std::mt19937_64 random(options.seed);
+			std::uniform_int_distribution<std::size_t> pick(0, samples.size() - 1);
+			std::vector<double> medians(std::max(options.nb_resample, std::size_t(1)));
+			std::vector<double> resample(samples.size());
+			for (double & median : medians)
+			{
+				for (double & t : resample) { t = samples[pick(random)]; }
+				std::sort(resample.begin(), resample.end());
+				median = quantile(resample, 0.5);
+			}
+			std::sort(medians.begin(), medians.end());
+			result.median_low = quantile(medians, (1 - options.confidence) / 2);
+			result.median_high = quantile(medians, 1 - (1 - options.confidence) / 2);
+			
+			m_results.push_back(std::move(result));
+			return m_results.back();
+		}
+		
+		/// @brief Return the results
+		/// @return the results
+		std::vector<hnc::benchmark_result> const & results() const { return m_results; }
+		
+		/// @brief Return the results as a hnc::benchmark (times per iteration)
+		/// @return the results as a hnc::benchmark
+		hnc::benchmark to_benchmark() const
+		{
+			hnc::benchmark b;
+			for (hnc::benchmark_result const & result : m_results)
+			{
+				for (double const t : result.samples) { b[result.name].push_back(t); }
+			}
+			return b;
+		}
+		
+		/// @brief Write the results in JSON
+		/// @param[in,out] o Output stream
+		/// @return the output stream
+		std::ostream & to_json(std::ostream & o) const
+		{
+			o << "{\n  \"unit\": \"s\",\n  \"benchmarks\":\n  [";
+			for (std::size_t i = 0; i < m_results.size(); ++i)
+			{
+				hnc::benchmark_result const & r = m_results[i];
+				o << ((i == 0) ? "\n" : ",\n");
+				o << "    {";
+				o << " \"name\": \"" << json_escape(r.name) << "\",";
+				o << " \"nb_iteration\": " << r.nb_iteration << ",";
+				o << " \"nb_sample\": " << r.samples.size() << ",";
+				o << " \"nb_outlier\": " << r.nb_outlier << ",";
+				o << " \"min\": " << r.min << ",";
+				o << " \"max\": " << r.max << ",";
+				o << " \"median\": " << r.median << ",";
+				o << " \"median_low\": " << r.median_low << ",";
+				o << " \"median_high\": " << r.median_high << ",";
+				o << " \"mean\": " << r.mean << ",";
+				o << " \"standard_deviation\": " << r.standard_deviation;
+				if (r.cycles >= 0)
+				{
+					o << ", \"cycles\": " << r.cycles << ", \"instructions\": " << r.instructions << ", \"cache_misses\": " << r.cache_misses;
+				}
+				o << " }";
+			}
+			o << "\n  ]\n}\n";
+			return o;
+		}
+		
+		/// @brief Write the results in CSV (one line per benchmark, empty counters if not measured)
+		/// @param[in,out] o Output stream
+		/// @return the output stream
+		std::ostream & to_csv(std::ostream & o) const
+		{
+			o << "name,nb_iteration,nb_sample,nb_outlier,min,max,median,median_low,median_high,mean,standard_deviation,cycles,instructions,cache_misses\n";
+			for (hnc::benchmark_result const & r : m_results)
+			{
+				o << "\"";
+				for (char const c : r.name) { o << ((c == '"') ? std::string("\"\"") : std::string(1, c)); }
+				o << "\"," << r.nb_iteration << "," << r.samples.size() << "," << r.nb_outlier << ",";
+				o << r.min << "," << r.max << "," << r.median << "," << r.median_low << "," << r.median_high << ",";
+				o << r.mean << "," << r.standard_deviation << ",";
+				if (r.cycles >= 0) { o << r.cycles << "," << r.instructions << "," << r.cache_misses; }
+				else { o << ",,"; }
+				o << "\n";
+			}
+			return o;
+		}
+		
+	private:
+		
+		/// @brief Execute a sample
+		/// @param[in] f            Function
+		/// @param[in] nb_iteration Number of iterations
+		/// @return the duration (in seconds)
+		template <class function_t>
+		static double time_sample(function_t & f, std::size_t const nb_iteration)
+		{
+			auto const time_first = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < nb_iteration; ++i) { f(); }
+			auto const time_last = std::chrono::steady_clock::now();
+			return std::chrono::duration<double>(time_last - time_first).count();
+		}
+		
+		/// @brief Return a quantile (linear interpolation)
+		/// @param[in] sorted Sorted values (not empty)
+		/// @param[in] q      Quantile (between 0 and 1)
+		/// @return the quantile
+		static double quantile(std::vector<double> const & sorted, double const q)
+		{
+			double const position = q * double(sorted.size() - 1);
+			std::size_t const i = std::size_t(position);
+			if (i + 1 >= sorted.size()) { return sorted.back(); }
+			return sorted[i] + (position - double(i)) * (sorted[i + 1] - sorted[i]);
+		}
+		
+		/// @brief Escape a string for JSON
+		/// @param[in] s String
+		/// @return the escaped string
+		static std::string json_escape(std::string const & s)
+		{
+			std::string r;
+			for (char const c : s)
+			{
+				if (c == '"' || c == '\\') { r += '\\'; r += c; }
+				else if (c == '\n') { r += "\\n"; }
+				else if ((unsigned char)(c) < 0x20) { r += ' '; }
+				else { r += c; }
+			}
+			return r;
+		}
+	};
+	
+	/// @brief Operator << between a std::ostream and a hnc::benchmark_runner
+	/// @param[in,out] o      Output stream
+	/// @param[in]     runner A hnc::benchmark_runner
+	/// @return the output stream
+	inline std::ostream & operator <<(std::ostream & o, hnc::benchmark_runner const & runner)
+	{
+		for (hnc::benchmark_result const & r : runner.results())
+		{
+			o << r.name << ":\n";
+			o << "- iterations per sample: " << r.nb_iteration << " (" << r.samples.size() << " samples, " << r.nb_outlier << " outliers)\n";
+			o << "- median:                " << r.median << " s [" << r.median_low << ", " << r.median_high << "]\n";
+			o << "- mean:                  " << r.mean << " s (standard deviation " << r.standard_deviation << ")\n";
+			o << "- min / max:             " << r.min << " / " << r.max << " s";
+			if (r.cycles >= 0)
+			{
+				o << "\n- cycles / instructions / cache misses: " << r.cycles << " / " << r.instructions << " / " << r.cache_misses;
+			}
+			if (&r != &runner.results().back()) { o << "\n"; }
+		}
+		return o;
+	}
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 
 #include "mpi/future.hpp"
+#include "mpi/genetic_algo.hpp"
 
 
 namespace hnc
@@ -0,0 +1,346 @@
+// Copyright © 2012, 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of hnc.
+
+// hnc is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// hnc is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+
+
+#ifndef HNC_MPI_GENETIC_ALGO_HPP
+#define HNC_MPI_GENETIC_ALGO_HPP
+
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#ifndef hnc_no_boost_mpi
+	#include <boost/mpi.hpp>
+#endif
+
+#include "../boost_serialization_std.hpp"
+#include "../algo/genetic_algo.hpp"
+
+
+#ifndef hnc_no_boost_serialization
+
+namespace boost
+{
+	namespace serialization
+	{
+		/// @brief Serialize a hnc::algo::genetic_algo::solution_grade_t (Boost.Serialization)
+		/// @param[in,out] archive  Archive
+		/// @param[in,out] solution A hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>
+		template <class archive_t, class solution_t, class grade_t>
+		void serialize(archive_t & archive, hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t> & solution, unsigned int const /*version*/)
+		{
+			archive & solution.solution;
+			archive & solution.grade;
+		}
+	}
+}
+
+#endif
+
+
+namespace hnc
+{
+	namespace mpi
+	{
+		#ifndef hnc_no_boost_mpi
+		
+		/**
+		 * @brief Distributed genetic algorithm (island model over MPI)
+		 *
+		 * @code
+		   #include <hnc/mpi/genetic_algo.hpp>
+		   @endcode
+		 * 
+		 * Each MPI process runs a hnc::algo::genetic_algo::genetic_algo on its own archipelagos
+		 * (same parameters and same T requirements, solution_t and grade_t must be serializable with Boost.Serialization). @n
+		 * The processes are on a ring: during an archipelago migration, the last archipelago of a process sends
+		 * the bests of its first island to the next process (asynchronous send), and the first archipelago
+		 * of the next process integrates the last migrants arrived (it never waits for them). @n
+		 * Only the best solution (the lower grade of all processes) and the stop criteria are reduced at each generation,
+		 * so all processes stop at the same generation with the same best solution. @n
+		 * The logs are displayed by the process 0 only.
+		 * 
+		 * All processes run the algorithm: use a boost::mpi::environment, not a hnc::mpi::environment
+		 * (its slaves wait for hnc::mpi::functor).
+		 * 
+		 * @code
+		   int main(int argc, char * argv[])
+		   {
+		   	boost::mpi::environment env(argc, argv);
+		   	
+		   	hnc::mpi::genetic_algo<solution_t, grade_t, evolve_functions_t> ga(evolve_functions_t(), 2, 4, 50);
+		   	
+		   	if (ga.rank() == 0) { std::cout << ga.best_solution() << std::endl; }
+		   }
+		   @endcode
+		 * 
+		 * @code
+		   mpirun -np 4 your_exe
+		   @endcode
+		 */
+		template
+		<
+			class solution_t,
+			class grade_t,
+			class T
+		>
+		class genetic_algo : public hnc::algo::genetic_algo::genetic_algo<solution_t, grade_t, T>
+		{
+		private:
+			
+			/// Local genetic algorithm
+			using base_t = hnc::algo::genetic_algo::genetic_algo<solution_t, grade_t, T>;
+			
+			/// MPI tag of the migrants
+			static int const tag_migration = 0;
+			
+			/// MPI tag of the number of migrations sent (end of the algorithm)
+			static int const tag_nb_migration = 1;
+			
+			/// Communicator (duplicate of MPI_COMM_WORLD, the messages do not interfere with the other MPI messages)
+			boost::mpi::communicator m_world;
+			
+			/// Rank of the next process on the ring
+			int const m_rank_next;
+			
+			/// Rank of the previous process on the ring
+			int const m_rank_previous;
+			
+			/// Sends not completed
+			std::vector<boost::mpi::request> m_send_requests;
+			
+			/// Migrants received from the previous process
+			hnc::algo::genetic_algo::island_t<hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t>> m_immigrants;
+			
+			/// Number of migrations sent to the next process
+			std::size_t m_nb_sent;
+			
+			/// Number of migrations received from the previous process
+			std::size_t m_nb_received;
+			
+			/// Best solution of all processes
+			hnc::algo::genetic_algo::solution_grade_t<solution_t, grade_t> m_global_best;
+			
+			/// m_global_best is set
+			bool m_global_best_is_set;
+			
+		public:
+			
+			/// @brief Constructor
+			/// @param[in] evolve_functions                            Objet that contains generate_solution, evaluate_solution, crossover, mutation and stop member functions
+			/// @param[in] nb_archipelago                              Number of archipelagos per process
+			/// @param[in] nb_island_per_archipelago                   Number of islands per archipelago
+			/// @param[in] nb_solution_per_island                      Number of solutions per island
+			/// @param[in] crossover_probability                       Probability a solution have to do a crossover (0.7 by default)
+			/// @param[in] mutation_probability                        Probability a solution have to do a mutation (0.1 by default)
+			/// @param[in] nb_migration_per_island                     Number of solution to be migrated during island migration
+			/// @param[in] nb_generation_between_island_migration      Number of generations to do between a island migration
+			/// @param[in] nb_migration_per_archipelago                Number of solution to be migrated during archipelago migration (between processes too)
+			/// @param[in] nb_generation_between_archipelago_migration Number of generations to do between a archipelago migration
+			/// @param[in] nb_same_solution_max                        Number of time the best solution can be the same (0 if unlimited, 20 by default)
+			/// @param[in] nb_generation_max                           Maximum number of generations (0 if unlimited, 0 by default)
+			/// @param[in] max_time                                    Maximum time in seconds for the algorithm (the first process which reaches it stops all processes)
+			/// @param[in] log_level                                   A hnc::algo::genetic_algo::log_level_t (used by the process 0 only)
+			genetic_algo
+			(
+				T const & evolve_functions,
+				std::size_t const nb_archipelago,
+				std::size_t const nb_island_per_archipelago,
+				std::size_t const nb_solution_per_island,
+				double const crossover_probability = 0.7,
+				double const mutation_probability = 0.1,
+				std::size_t const nb_migration_per_island = 3,
+				std::size_t const nb_generation_between_island_migration = 5,
+				std::size_t const nb_migration_per_archipelago = 2,
+				std::size_t const nb_generation_between_archipelago_migration = 10,
+				std::size_t const nb_same_solution_max = 20,
+				std::size_t const nb_generation_max = 0,
+				long double const max_time = 0.0,
+				hnc::algo::genetic_algo::log_level_t const log_level = hnc::algo::genetic_algo::log_level_t::no_log
+			) :
+				base_t
+				(
+					typename base_t::no_evolve_t(),
+					evolve_functions,
+					nb_archipelago,
+					nb_island_per_archipelago,
+					nb_solution_per_island,
+					crossover_probability,
+					mutation_probability,
+					nb_migration_per_island,
+					nb_generation_between_island_migration,
+					nb_migration_per_archipelago,
+					nb_generation_between_archipelago_migration,
+					nb_same_solution_max,
+					nb_generation_max,
+					max_time,
+					(boost::mpi::communicator().rank() == 0) ? log_level : hnc::algo::genetic_algo::log_level_t::no_log
+				),
+				m_world(MPI_COMM_WORLD, boost::mpi::comm_duplicate),
+				m_rank_next((m_world.rank() + 1) % m_world.size()),
+				m_rank_previous((m_world.rank() + m_world.size() - 1) % m_world.size()),
+				m_send_requests(),
+				m_immigrants(),
+				m_nb_sent(0),
+				m_nb_received(0),
+				m_global_best(),
+				m_global_best_is_set(false)
+			{
+				find_best_solution();
+				this->evolve();
+				end_migrations();
+			}
+			
+			/// @brief Return the rank of this process
+			/// @return the rank of this process
+			int rank() const { return m_world.rank(); }
+			
+			/// @brief Return the number of processes
+			/// @return the number of processes
+			int nb_process() const { return m_world.size(); }
+			
+			/// @brief Return the number of migrations sent to the next process
+			/// @return the number of migrations sent
+			std::size_t nb_migration_sent() const { return m_nb_sent; }
+			
+			/// @brief Return the number of migrations received from the previous process
+			/// @return the number of migrations received
+			std::size_t nb_migration_received() const { return m_nb_received; }
+			
+		private:
+			
+			/// @brief Return true if the stop criteria are not reached by all processes
+			/// @return true if the algorithm must continue, false otherwise
+			bool must_continue() override
+			{
+				bool const local_must_continue = base_t::must_continue();
+				return boost::mpi::all_reduce(m_world, local_must_continue, std::logical_and<bool>());
+			}
+			
+			/// @brief Migration between archipelagos, the processes are on a ring
+			void migration_between_archipelagos() override
+			{
+				hnc::out(this->log_level, hnc::algo::genetic_algo::log_level_t::minimal_plus_log) << "  " << "+ Migration between archipelagos" << std::endl;
+				
+				auto & solutions = this->m_solutions;
+				auto & migrants = this->m_migrants;
+				std::ptrdiff_t const nb_migration = std::ptrdiff_t(this->nb_migration_per_archipelago);
+				
+				// Copy the x bests of the first island of each archipelago
+				for (std::size_t archipelago = 0; archipelago < solutions.size(); ++archipelago)
+				{
+					migrants[archipelago].assign(solutions[archipelago][0].begin(), solutions[archipelago][0].begin() + nb_migration);
+				}
+				
+				// Send the x bests of the last archipelago to the next process (the data is serialized, the send is asynchronous)
+				m_send_requests.push_back(m_world.isend(m_rank_next, tag_migration, migrants[solutions.size() - 1]));
+				++m_nb_sent;
+				m_send_requests.erase
+				(
+					std::remove_if(m_send_requests.begin(), m_send_requests.end(), [](boost::mpi::request & request) { return bool(request.test()); }),
+					m_send_requests.end()
+				);
+				
+				// Receive the migrants arrived from the previous process (only the last ones are kept)
+				bool received = false;
+				while (m_world.iprobe(m_rank_previous, tag_migration))
+				{
+					m_world.recv(m_rank_previous, tag_migration, m_immigrants);
+					++m_nb_received;
+					received = true;
+				}
+				if (m_immigrants.size() > solutions[0][0].size())
+				{
+					m_immigrants.erase(m_immigrants.begin() + std::ptrdiff_t(solutions[0][0].size()), m_immigrants.end());
+				}
+				
+				// Replace x worst solutions by the x bests of the previous archipelago (the migrants of the previous process for the first archipelago)
+				#pragma omp parallel for
+				for (long int i = 0; i < (long int)(solutions.size()); ++i)
+				{
+					std::size_t const archipelago = std::size_t(i);
+					
+					hnc::out(this->log_level, hnc::algo::genetic_algo::log_level_t::archipelago_log) << "  " << "  " << "Archipelago " << archipelago << "/" << solutions.size() << std::endl;
+					
+					if (archipelago != 0)
+					{
+						this->immigration(solutions[archipelago][0], migrants[archipelago - 1]);
+					}
+					else if (received)
+					{
+						this->immigration(solutions[0][0], m_immigrants);
+					}
+				}
+			}
+			
+			/// @brief Update the best solution with the best solution of all processes
+			void find_best_solution() override
+			{
+				base_t::find_best_solution();
+				
+				// Best grade of each process
+				std::vector<grade_t> grades;
+				boost::mpi::all_gather(m_world, this->best_solution().grade, grades);
+				
+				// Process with the best solution (the lower rank if equal)
+				int best_rank = 0;
+				for (int rank = 1; rank < int(grades.size()); ++rank)
+				{
+					if (grades[std::size_t(rank)] < grades[std::size_t(best_rank)]) { best_rank = rank; }
+				}
+				
+				// Broadcast the solution if it is better (same decision on all processes)
+				if (m_global_best_is_set == false || grades[std::size_t(best_rank)] < m_global_best.grade)
+				{
+					if (m_world.rank() == best_rank) { m_global_best = this->best_solution(); }
+					boost::mpi::broadcast(m_world, m_global_best, best_rank);
+					m_global_best_is_set = true;
+				}
+				
+				this->m_best_solution = std::cref(m_global_best);
+			}
+			
+			/// @brief Receive the migrations not received and wait the sends (at the end of the algorithm)
+			void end_migrations()
+			{
+				boost::mpi::request request = m_world.isend(m_rank_next, tag_nb_migration, m_nb_sent);
+				std::size_t nb_sent_by_previous = 0;
+				m_world.recv(m_rank_previous, tag_nb_migration, nb_sent_by_previous);
+				
+				// The messages between two processes are received in order
+				for (; m_nb_received < nb_sent_by_previous; ++m_nb_received)
+				{
+					m_world.recv(m_rank_previous, tag_migration, m_immigrants);
+				}
+				
+				request.wait();
+				boost::mpi::wait_all(m_send_requests.begin(), m_send_requests.end());
+				m_send_requests.clear();
+			}
+		};
+		
+		#else
+		
+		/// @brief Without Boost.MPI, the distributed genetic algorithm is the local genetic algorithm
+		template <class solution_t, class grade_t, class T>
+		using genetic_algo = hnc::algo::genetic_algo::genetic_algo<solution_t, grade_t, T>;
+		
+		#endif
+	}
+}
+
+#endif
@@ -17,6 +17,7 @@
 #define HNC_SCHEDULER_HPP
 
 #include "scheduler/iteration.hpp"
+#include "scheduler/iteration_parallel.hpp"
 
 
 namespace hnc
@@ -0,0 +1,484 @@
+// Copyright © 2012-2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HNC_SCHEDULER_ITERATION_PARALLEL_HPP
+#define HNC_SCHEDULER_ITERATION_PARALLEL_HPP
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+
+namespace hnc
+{
+	namespace scheduler
+	{
+		/**
+		 * @brief Timing statistics of a version (time per iteration, exponentially decaying)
+		 *
+		 * @code
+		   #include <hnc/scheduler.hpp>
+		   @endcode
+		 */
+		class version_statistics
+		{
+		public:
+			
+			/// Number of measures
+			std::size_t nb_measure = 0;
+			
+			/// Decaying mean of the time per iteration (in nanoseconds)
+			double time_per_it = 0;
+			
+			/// @brief Add a measure
+			/// @param[in] time  Time per iteration (in nanoseconds)
+			/// @param[in] decay Weight of the previous mean (between 0 and 1)
+			void add(double const time, double const decay)
+			{
+				time_per_it = (nb_measure == 0) ? time : decay * time_per_it + (1 - decay) * time;
+				++nb_measure;
+			}
+		};
+		
+		/**
+		 * @brief Parallel version of hnc::scheduler::iteration: chunks of iterations executed by a work-stealing pool of threads, each chunk with the version which is the fastest now
+		 *
+		 * @code
+		   #include <hnc/scheduler.hpp>
+		   @endcode
+		 *
+		 * The iterations are split in chunks of nb_it_sample + nb_it_compute iterations. @n
+		 * Each thread starts with a contiguous part of the chunks and steals half of the remaining chunks of another thread when it has no more chunk. @n
+		 * For each chunk, a thread:
+		 * 1. executes one version (all versions in turn) on nb_it_sample iterations (sample)
+		 * 2. executes the best version on the other iterations of the chunk
+		 *
+		 * Each thread keeps its own statistics per version. All measures (sample and compute) update a shared estimate of
+		 * the time per iteration of each version, which decays so that the best version can change during the computation. @n
+		 * The threads and the estimates are kept between two calls (for example one call per frame on the rows of an image).
+		 *
+		 * @code
+		   hnc::scheduler::iteration_parallel<std::size_t> rows
+		   (
+		   	{
+		   		[&](std::size_t const & first, std::size_t const & last) { for (std::size_t row = first; row < last; ++row) { filter_scalar(image, row); } },
+		   		[&](std::size_t const & first, std::size_t const & last) { for (std::size_t row = first; row < last; ++row) { filter_simd(image, row); } }
+		   	},
+		   	4, 28
+		   );
+		   // Each frame
+		   rows(0, image.nb_row());
+		   @endcode
+		 *
+		 * @pre The versions can be executed at the same time on different iterations
+		 * @pre The preconditions of hnc::scheduler::iteration
+		 */
+		template <class it_t, class incr_t = std::size_t>
+		class iteration_parallel
+		{
+		public:
+			
+			/// Version type
+			using version_t = std::function<void(it_t const &, it_t const &)>;
+			
+		private:
+			
+			/// Worker (one per thread)
+			class worker_t
+			{
+			public:
+				
+				/// Protect begin and end
+				std::mutex mutex;
+				
+				/// First chunk not executed
+				std::size_t begin = 0;
+				
+				/// Last chunk (not included)
+				std::size_t end = 0;
+				
+				/// Statistics of the versions
+				std::vector<hnc::scheduler::version_statistics> statistics;
+				
+				/// Next sampled version
+				std::size_t next_sample = 0;
+			};
+			
+			/// Versions
+			std::vector<version_t> m_versions;
+			
+			/// Number of iterations for sample phases
+			it_t m_nb_it_sample;
+			
+			/// Number of iterations for compute phases
+			it_t m_nb_it_compute;
+			
+			/// Incrementation in the loop
+			incr_t m_step;
+			
+			/// Weight of the previous estimate
+			double m_decay;
+			
+			/// Shared estimate of the time per iteration of each version (in nanoseconds, < 0 if unknown)
+			std::unique_ptr<std::atomic<double>[]> m_estimates;
+			
+			/// Workers
+			std::unique_ptr<worker_t[]> m_workers;
+			
+			/// Number of workers
+			std::size_t m_nb_worker;
+			
+			/// Threads (the worker 0 is the calling thread)
+			std::vector<std::thread> m_threads;
+			
+			/// Protect the job
+			std::mutex m_mutex;
+			
+			/// Wake up the threads
+			std::condition_variable m_job_cv;
+			
+			/// Wake up the calling thread
+			std::condition_variable m_done_cv;
+			
+			/// Job number (incremented for each call)
+			std::size_t m_job;
+			
+			/// Number of threads which have not finished the job
+			std::size_t m_nb_running;
+			
+			/// Stop the threads
+			bool m_stop;
+			
+			/// First iteration of the job
+			it_t m_first;
+			
+			/// Last iteration of the job
+			it_t m_last;
+			
+			/// Stop the job (exception in a version)
+			std::atomic<bool> m_abort;
+			
+			/// First exception thrown by a version
+			std::exception_ptr m_exception;
+			
+		public:
+			
+			/**
+			 * @brief Constructor
+			 * @param[in] versions      Functions with a first and a last and with the same computing
+			 * @param[in] nb_it_sample  Number of iterations for sample phases
+			 * @param[in] nb_it_compute Number of iterations for compute phases
+			 * @param[in] step          Incrementation in the loop (1 by default)
+			 * @param[in] nb_thread     Number of threads (std::thread::hardware_concurrency() by default)
+			 * @param[in] decay         Weight of the previous estimate when a time is measured (0.75 by default)
+			 */
+			iteration_parallel
+			(
+				std::vector<version_t> const & versions,
+				it_t const & nb_it_sample = 2 * 4 * 6,
+				it_t const & nb_it_compute = (2 * 4 * 6) * 10,
+				incr_t const & step = 1,
+				std::size_t const nb_thread = std::thread::hardware_concurrency(),
+				double const decay = 0.75
+			) :
+				m_versions(versions),
+				m_nb_it_sample(nb_it_sample),
+				m_nb_it_compute(nb_it_compute),
+				m_step(step),
+				m_decay(decay),
+				m_estimates(new std::atomic<double>[versions.size()]),
+				m_workers(new worker_t[std::max(nb_thread, std::size_t(1))]),
+				m_nb_worker(std::max(nb_thread, std::size_t(1))),
+				m_threads(),
+				m_job(0),
+				m_nb_running(0),
+				m_stop(false),
+				m_first(),
+				m_last(),
+				m_abort(false),
+				m_exception()
+			{
+				for (std::size_t v = 0; v < m_versions.size(); ++v) { m_estimates[v].store(-1); }
+				for (std::size_t w = 0; w < m_nb_worker; ++w)
+				{
+					m_workers[w].statistics.resize(m_versions.size());
+					m_workers[w].next_sample = w % std::max(m_versions.size(), std::size_t(1));
+				}
+				for (std::size_t w = 1; w < m_nb_worker; ++w)
+				{
+					m_threads.emplace_back([this, w]() { thread_loop(w); });
+				}
+			}
+			
+			/// @brief Copy constructor (deleted)
+			iteration_parallel(iteration_parallel const &) = delete;
+			
+			/// @brief Copy assignment (deleted)
+			iteration_parallel & operator =(iteration_parallel const &) = delete;
+			
+			/// @brief Destructor, stop the threads
+			~iteration_parallel()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_job_cv.notify_all();
+				for (std::thread & thread : m_threads) { thread.join(); }
+			}
+			
+			/**
+			 * @brief Execute the iterations from first to last (not included)
+			 * @param[in] first First iteration
+			 * @param[in] last  Last iteration (not included)
+			 * @exception the first exception thrown by a version (the other chunks are not executed)
+			 */
+			void operator()(it_t const & first, it_t const & last)
+			{
+				if (!(first < last) || m_versions.empty()) { return; }
+				
+				// Split the chunks between the workers
+				std::size_t const nb_chunk = std::size_t((last - first + chunk_span() - it_t(1)) / chunk_span());
+				for (std::size_t w = 0; w < m_nb_worker; ++w)
+				{
+					std::lock_guard<std::mutex> lock(m_workers[w].mutex);
+					m_workers[w].begin = nb_chunk * w / m_nb_worker;
+					m_workers[w].end = nb_chunk * (w + 1) / m_nb_worker;
+				}
+				
+				// Wake up the threads
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_first = first;
+					m_last = last;
+					m_abort = false;
+					m_exception = nullptr;
+					m_nb_running = m_nb_worker - 1;
+					++m_job;
+				}
+				m_job_cv.notify_all();
+				
+				// Work
+				work(0);
+				
+				// Wait for the threads
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_done_cv.wait(lock, [&]() { return m_nb_running == 0; });
+				
+				if (m_exception) { std::rethrow_exception(m_exception); }
+			}
+			
+			/// @brief Return the number of threads
+			/// @return the number of threads
+			std::size_t nb_thread() const { return m_nb_worker; }
+			
+			/// @brief Return the shared estimate of the time per iteration of a version
+			/// @param[in] version Index of the version
+			/// @return the time per iteration (in nanoseconds), < 0 if the version was not executed
+			double estimate(std::size_t const version) const { return m_estimates[version].load(); }
+			
+			/// @brief Return the statistics of a version in a thread
+			/// @param[in] thread  Index of the thread
+			/// @param[in] version Index of the version
+			/// @return the statistics of the version in the thread
+			/// @warning Do not call it during the execution
+			hnc::scheduler::version_statistics const & statistics(std::size_t const thread, std::size_t const version) const
+			{
+				return m_workers[thread].statistics[version];
+			}
+			
+			/// @brief Return the best version according to the shared estimate
+			/// @return the index of the best version
+			std::size_t best_version() const
+			{
+				std::size_t best = 0;
+				double best_time = -1;
+				for (std::size_t v = 0; v < m_versions.size(); ++v)
+				{
+					double const time = m_estimates[v].load(std::memory_order_relaxed);
+					if (time >= 0 && (best_time < 0 || time < best_time)) { best = v; best_time = time; }
+				}
+				return best;
+			}
+			
+		private:
+			
+			/// @brief Return the number of iterations (with the step) in a chunk
+			/// @return the number of iterations (with the step) in a chunk
+			it_t chunk_span() const
+			{
+				return (m_nb_it_sample + m_nb_it_compute) * it_t(m_step);
+			}
+			
+			/// @brief Loop of a thread
+			/// @param[in] w Index of the worker
+			void thread_loop(std::size_t const w)
+			{
+				std::size_t job = 0;
+				while (true)
+				{
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_job_cv.wait(lock, [&]() { return m_stop || m_job != job; });
+						if (m_stop) { return; }
+						job = m_job;
+					}
+					
+					work(w);
+					
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						--m_nb_running;
+					}
+					m_done_cv.notify_one();
+				}
+			}
+			
+			/// @brief Take a chunk (own chunks first, then steal half of the chunks of another worker)
+			/// @param[in]  w     Index of the worker
+			/// @param[out] chunk Index of the chunk
+			/// @return true if there is a chunk, false if all chunks are taken
+			bool take_chunk(std::size_t const w, std::size_t & chunk)
+			{
+				worker_t & worker = m_workers[w];
+				{
+					std::lock_guard<std::mutex> lock(worker.mutex);
+					if (worker.begin < worker.end) { chunk = worker.begin++; return true; }
+				}
+				
+				for (std::size_t i = 1; i < m_nb_worker; ++i)
+				{
+					worker_t & victim = m_workers[(w + i) % m_nb_worker];
+					std::size_t begin = 0;
+					std::size_t end = 0;
+					{
+						std::lock_guard<std::mutex> lock(victim.mutex);
+						if (victim.begin == victim.end) { continue; }
+						begin = victim.begin + (victim.end - victim.begin) / 2;
+						end = victim.end;
+						victim.end = begin;
+					}
+					chunk = begin;
+					std::lock_guard<std::mutex> lock(worker.mutex);
+					worker.begin = begin + 1;
+					worker.end = end;
+					return true;
+				}
+				
+				return false;
+			}
+			
+			/// @brief Execute a version and update the statistics
+			/// @param[in,out] worker  Worker
+			/// @param[in]     version Index of the version
+			/// @param[in]     first   First iteration
+			/// @param[in]     last    Last iteration (not included)
+			/// @param[in]     nb_it   Number of iterations
+			void run(worker_t & worker, std::size_t const version, it_t const & first, it_t const & last, double const nb_it)
+			{
+				auto const time_first = std::chrono::steady_clock::now();
+				m_versions[version](first, last);
+				auto const time_last = std::chrono::steady_clock::now();
+				
+				double const time = double(std::chrono::duration_cast<std::chrono::nanoseconds>(time_last - time_first).count()) / nb_it;
+				
+				worker.statistics[version].add(time, m_decay);
+				
+				double estimate = m_estimates[version].load(std::memory_order_relaxed);
+				double new_estimate = 0;
+				do
+				{
+					new_estimate = (estimate < 0) ? time : m_decay * estimate + (1 - m_decay) * time;
+				}
+				while (m_estimates[version].compare_exchange_weak(estimate, new_estimate, std::memory_order_relaxed) == false);
+			}
+			
+			/// @brief Execute chunks
+			/// @param[in] w Index of the worker
+			void work(std::size_t const w)
+			{
+				worker_t & worker = m_workers[w];
+				std::size_t chunk = 0;
+				
+				while (m_abort.load(std::memory_order_relaxed) == false && take_chunk(w, chunk))
+				{
+					it_t const chunk_first = m_first + it_t(chunk) * chunk_span();
+					it_t const chunk_last = std::min(it_t(chunk_first + chunk_span()), m_last);
+					it_t const sample_last = std::min(it_t(chunk_first + m_nb_it_sample * it_t(m_step)), chunk_last);
+					
+					try
+					{
+						// Sample (one version per chunk, in turn)
+						std::size_t const sampled = worker.next_sample;
+						worker.next_sample = (worker.next_sample + 1) % m_versions.size();
+						run(worker, sampled, chunk_first, sample_last, double(sample_last - chunk_first) / double(m_step));
+						
+						// Compute
+						if (sample_last < chunk_last)
+						{
+							run(worker, best_version(), sample_last, chunk_last, double(chunk_last - sample_last) / double(m_step));
+						}
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						if (m_exception == nullptr) { m_exception = std::current_exception(); }
+						m_abort = true;
+					}
+				}
+			}
+		};
+		
+		/**
+		 * @brief Execute different versions of for loop on several threads (see hnc::scheduler::iteration_parallel)
+		 *
+		 * @code
+		   #include <hnc/scheduler.hpp>
+		   @endcode
+		 *
+		 * @param[in] first         First iteration
+		 * @param[in] last          Last iteration (not included)
+		 * @param[in] versions      Functions with a first and a last and with the same computing
+		 * @param[in] nb_it_sample  Number of iterations for sample phases
+		 * @param[in] nb_it_compute Number of iterations for compute phases
+		 * @param[in] step          Incrementation in the loop (1 by default)
+		 * @param[in] nb_thread     Number of threads (std::thread::hardware_concurrency() by default)
+		 */
+		template <class it_t, class incr_t = std::size_t>
+		inline void iteration_parallel_run
+		(
+			it_t const & first,
+			it_t const & last,
+			std::vector<std::function<void(it_t const &, it_t const &)>> const & versions,
+			it_t const & nb_it_sample = 2 * 4 * 6,
+			it_t const & nb_it_compute = (2 * 4 * 6) * 10,
+			incr_t const & step = 1,
+			std::size_t const nb_thread = std::thread::hardware_concurrency()
+		)
+		{
+			hnc::scheduler::iteration_parallel<it_t, incr_t> scheduler(versions, nb_it_sample, nb_it_compute, step, nb_thread);
+			scheduler(first, last);
+		}
+	}
+}
+
+#endif
@@ -17,12 +17,16 @@
 #define HNC_VECTOR2D_HPP
 
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 #include "index2D.hpp"
 #include "assert.hpp"
 #include "to_string.hpp"
 #include "iterator.hpp"
 #include "serialization.hpp"
+#include "aligned_allocator.hpp"
 
 
 namespace hnc
@@ -34,11 +38,19 @@ namespace hnc
 	   #include <hnc/vector2D.hpp>
 	   @endcode
 	 *
+	 * The rows are stored one after the other, each row starts stride() elements after the previous one. @n
+	 * The rows of [i] and the iterators are views computed from the stride (nothing to rebuild on copy, move or resize).
+	 *
+	 * With alignment greater than alignof(T), each row starts on a multiple of alignment bytes
+	 * (for example 64 for the cache lines and the SIMD instructions) and stride() can be greater than nb_col(). @n
+	 * With the default alignment, stride() == nb_col() and data() is a contiguous nb_row() * nb_col() array.
+	 *
 	 * @note For other use, have a look to:
 	 * - hnc::vector2D_minimal
 	 * - hnc::vector2D_C_style_minimal
+	 * - hnc::vector2D_growable (capacity in both dimensions, for grids which grow at the edges)
 	 */
-	template <class T>
+	template <class T, std::size_t alignment = alignof(T)>
 	class vector2D
 	{
 	public:
@@ -55,31 +67,31 @@ namespace hnc
 		{
 		private:
 
-			/// Associated vector2D
-			hnc::vector2D<U> const * p_data;
+			/// First element of the row
+			U const * p_row;
 
-			/// Row index
-			std::size_t m_i;
+			/// Number of columns
+			std::size_t m_size;
 
 		public:
 
 			/// Const iterator
-			using const_iterator = hnc::const_iterator<U, line_const_ptr<U>>;
+			using const_iterator = U const *;
 
 			/// Const reverse iterator
-			using const_reverse_iterator = hnc::const_reverse_iterator<U, line_const_ptr<U>>;
+			using const_reverse_iterator = std::reverse_iterator<U const *>;
 
 			/// @brief Constructor
-			/// @param[in] p A hnc::vector2D
-			/// @param[in] i Row index
-			line_const_ptr(hnc::vector2D<U> const * p = nullptr, std::size_t const i = 0) : p_data(p), m_i(i)
+			/// @param[in] p    First element of the row
+			/// @param[in] size Number of columns
+			line_const_ptr(U const * p = nullptr, std::size_t const size = 0) : p_row(p), m_size(size)
 			{ }
 
 			/// @brief Return the number of columns
 			/// @return the number of columns
 			std::size_t size() const
 			{
-				return p_data->nb_col();
+				return m_size;
 			}
 
 			/// @brief Const access by [i][j]
@@ -87,7 +99,7 @@ namespace hnc
 			/// @return the value at [i][j]
 			U const & operator[](std::size_t const j) const
 			{
-				return (*p_data)(m_i, j);
+				return p_row[j];
 			}
 			
 			/// @brief Const access to the first value of the line
@@ -95,7 +107,7 @@ namespace hnc
 			/// @return a proxy to have the first value of the line
 			U const & front() const
 			{
-				return (*p_data)(m_i, 0);
+				return p_row[0];
 			}
 
 			/// @brief Const access to the last value of the line
@@ -103,35 +115,35 @@ namespace hnc
 			/// @return a proxy to have the last value of the line
 			U const & back() const
 			{
-				return (*p_data)(m_i, p_data->nb_col() - 1);
+				return p_row[m_size - 1];
 			}
 			
 			/// @brief Return a const iterator to the beginning
 			/// @return a const iterator to the beginning
 			const_iterator begin() const
 			{
-				return const_iterator(*this, 0);
+				return p_row;
 			}
 
 			/// @brief Return a const iterator to the end
 			/// @return a const iterator to the end
 			const_iterator end() const
 			{
-				return const_iterator(*this, size());
+				return p_row + m_size;
 			}
 
 			/// @brief Return a const iterator to the beginning
 			/// @return a const iterator to the beginning
 			const_reverse_iterator rbegin() const
 			{
-				return const_reverse_iterator(*this, size() - 1);
+				return const_reverse_iterator(end());
 			}
 
 			/// @brief Return a const iterator to the end
 			/// @return a const iterator to the end
 			const_reverse_iterator rend() const
 			{
-				return const_reverse_iterator(*this, 0);
+				return const_reverse_iterator(begin());
 			}
 		};
 
@@ -147,37 +159,44 @@ namespace hnc
 		{
 		private:
 
-			/// Associated vector2D
-			hnc::vector2D<U> * p_data;
+			/// First element of the row
+			U * p_row;
 
-			/// Row index
-			std::size_t m_i;
+			/// Number of columns
+			std::size_t m_size;
 
 		public:
 
 			/// Iterator
-			using iterator = hnc::iterator<U, line_ptr<U>>;
+			using iterator = U *;
 
 			/// Const iterator
-			using const_iterator = hnc::const_iterator<U, line_ptr<U>>;
+			using const_iterator = U const *;
 
 			/// Reverse iterator
-			using reverse_iterator = hnc::reverse_iterator<U, line_ptr<U>>;
+			using reverse_iterator = std::reverse_iterator<U *>;
 
 			/// Const reverse iterator
-			using const_reverse_iterator = hnc::const_reverse_iterator<U, line_ptr<U>>;
+			using const_reverse_iterator = std::reverse_iterator<U const *>;
 
 			/// @brief Constructor
-			/// @param[in,out] p A hnc::vector2D
-			/// @param[in]     i Row index
-			line_ptr(hnc::vector2D<U> * p = nullptr, std::size_t const i = 0) : p_data(p), m_i(i)
+			/// @param[in] p    First element of the row
+			/// @param[in] size Number of columns
+			line_ptr(U * p = nullptr, std::size_t const size = 0) : p_row(p), m_size(size)
 			{ }
 
+			/// @brief Conversion to a const line
+			/// @return the const line
+			operator line_const_ptr<U>() const
+			{
+				return line_const_ptr<U>(p_row, m_size);
+			}
+
 			/// @brief Return the number of columns
 			/// @return the number of columns
 			std::size_t size() const
 			{
-				return p_data->nb_col();
+				return m_size;
 			}
 
 			/// @brief Const access by [i][j]
@@ -185,7 +204,7 @@ namespace hnc
 			/// @return the value at [i][j]
 			U const & operator[](std::size_t const j) const
 			{
-				return (*p_data)(m_i, j);
+				return p_row[j];
 			}
 
 			/// @brief Acces by [i][j]
@@ -193,7 +212,7 @@ namespace hnc
 			/// @return the value at [i][j]
 			U & operator[](std::size_t const j)
 			{
-				return (*p_data)(m_i, j);
+				return p_row[j];
 			}
 
 			/// @brief Const access to the first value of the line
@@ -201,7 +220,7 @@ namespace hnc
 			/// @return a proxy to have the first value of the line
 			U const & front() const
 			{
-				return (*p_data)(m_i, 0);
+				return p_row[0];
 			}
 			
 			/// @brief Access to the first value of the line
@@ -209,7 +228,7 @@ namespace hnc
 			/// @return a proxy to have the first value of the line
 			U & front()
 			{
-				return (*p_data)(m_i, 0);
+				return p_row[0];
 			}
 
 			/// @brief Const access to the last value of the line
@@ -217,7 +236,7 @@ namespace hnc
 			/// @return a proxy to have the last value of the line
 			U const & back() const
 			{
-				return (*p_data)(m_i, p_data->nb_col() - 1);
+				return p_row[m_size - 1];
 			}
 			
 			/// @brief Const access to the last value of the line
@@ -225,82 +244,231 @@ namespace hnc
 			/// @return a proxy to have the last value of the line
 			U & back()
 			{
-				return (*p_data)(m_i, p_data->nb_col() - 1);
+				return p_row[m_size - 1];
 			}
 
 			/// @brief Return a iterator to the beginning
 			/// @return a iterator to the beginning
 			iterator begin()
 			{
-				return iterator(*this, 0);
+				return p_row;
 			}
 
 			/// @brief Return a iterator to the end
 			/// @return a iterator the to end
 			iterator end()
 			{
-				return iterator(*this, size());
+				return p_row + m_size;
 			}
 
 			/// @brief Return a const iterator to the beginning
 			/// @return a const iterator to the beginning
 			const_iterator begin() const
 			{
-				return const_iterator(*this, 0);
+				return p_row;
 			}
 
 			/// @brief Return a const iterator to the end
 			/// @return a const iterator to the end
 			const_iterator end() const
 			{
-				return const_iterator(*this, size());
+				return p_row + m_size;
 			}
 
 			/// @brief Return a reverse iterator to the beginning
 			/// @return a reverse iterator to the beginning
 			reverse_iterator rbegin()
 			{
-				return reverse_iterator(*this, size() - 1);
+				return reverse_iterator(end());
 			}
 
 			/// @brief Return a reverse iterator to the end
 			/// @return a reverse iterator the to end
 			reverse_iterator rend()
 			{
-				return reverse_iterator(*this, 0);
+				return reverse_iterator(begin());
 			}
 
 			/// @brief Return a const reverse iterator to the beginning
 			/// @return a const reverse iterator to the beginning
 			const_reverse_iterator rbegin() const
 			{
-				return const_reverse_iterator(*this, size() - 1);
+				return const_reverse_iterator(end());
 			}
 
 			/// @brief Return a const reverse iterator to the end
 			/// @return a const reverse iterator to the end
 			const_reverse_iterator rend() const
 			{
-				return const_reverse_iterator(*this, 0);
+				return const_reverse_iterator(begin());
+			}
+		};
+
+		/// @brief Result of row_iterator::operator-> (contains the view of the row)
+		template <class line_t>
+		class row_arrow_proxy
+		{
+		private:
+
+			/// View of the row
+			line_t m_line;
+
+		public:
+
+			/// @brief Constructor
+			/// @param[in] line View of the row
+			explicit row_arrow_proxy(line_t const & line) : m_line(line) { }
+
+			/// @brief Return the view of the row
+			/// @return the view of the row
+			line_t * operator ->() { return &m_line; }
+		};
+
+		/**
+		 * @brief Random access iterator on the rows of a hnc::vector2D
+		 * 
+		 * @code
+		   #include <hnc/vector2D.hpp>
+		   @endcode
+		 * 
+		 * The reference type is the view of the row (line_t, returned by value), it stays valid when the iterator is moved or destroyed
+		 */
+		template <class line_t, class pointer_t, int direction>
+		class row_iterator : public std::iterator<std::random_access_iterator_tag, line_t, std::ptrdiff_t, row_arrow_proxy<line_t>, line_t>
+		{
+		private:
+
+			/// First element of the first row
+			pointer_t p_data;
+
+			/// Number of elements between two rows
+			std::size_t m_stride;
+
+			/// Number of columns
+			std::size_t m_nb_col;
+
+			/// Row index
+			std::ptrdiff_t m_i;
+
+		public:
+
+			/// @brief Constructor
+			/// @param[in] p      First element of the first row
+			/// @param[in] stride Number of elements between two rows
+			/// @param[in] nb_col Number of columns
+			/// @param[in] i      Row index
+			row_iterator(pointer_t const p = nullptr, std::size_t const stride = 0, std::size_t const nb_col = 0, std::ptrdiff_t const i = 0) :
+				p_data(p), m_stride(stride), m_nb_col(nb_col), m_i(i)
+			{ }
+
+			/// @brief Return the row pointed by the iterator
+			/// @return the row pointed by the iterator
+			line_t operator *() const
+			{
+				return line_t(p_data + std::size_t(m_i) * m_stride, m_nb_col);
+			}
+
+			/// @brief Return the row pointed by the iterator
+			/// @return the row pointed by the iterator
+			row_arrow_proxy<line_t> operator ->() const
+			{
+				return row_arrow_proxy<line_t>(**this);
+			}
+
+			/// @brief Return the row n after the iterator
+			/// @param[in] n Offset
+			/// @return the row
+			line_t operator[](std::ptrdiff_t const n) const
+			{
+				return *(*this + n);
 			}
+
+			/// @brief Pre-incrementation of the iterator
+			/// @return the iterator
+			row_iterator & operator ++() { m_i += direction; return *this; }
+
+			/// @brief Post-incrementation of the iterator
+			/// @return a copy of the iterator before the incrementation
+			row_iterator operator ++(int) { row_iterator copy = *this; ++(*this); return copy; }
+
+			/// @brief Pre-decrementation of the iterator
+			/// @return the iterator
+			row_iterator & operator --() { m_i -= direction; return *this; }
+
+			/// @brief Post-decrementation of the iterator
+			/// @return a copy of the iterator before the decrementation
+			row_iterator operator --(int) { row_iterator copy = *this; --(*this); return copy; }
+
+			/// @brief Operator +=
+			/// @param[in] n Offset
+			/// @return the iterator
+			row_iterator & operator +=(std::ptrdiff_t const n) { m_i += direction * n; return *this; }
+
+			/// @brief Operator -=
+			/// @param[in] n Offset
+			/// @return the iterator
+			row_iterator & operator -=(std::ptrdiff_t const n) { m_i -= direction * n; return *this; }
+
+			/// @brief Operator +
+			/// @param[in] n Offset
+			/// @return a copy of the iterator after operation
+			row_iterator operator +(std::ptrdiff_t const n) const { row_iterator copy = *this; return copy += n; }
+
+			/// @brief Operator -
+			/// @param[in] n Offset
+			/// @return a copy of the iterator after operation
+			row_iterator operator -(std::ptrdiff_t const n) const { row_iterator copy = *this; return copy -= n; }
+
+			/// @brief Distance between two iterators
+			/// @param[in] it An iterator
+			/// @return the distance
+			std::ptrdiff_t operator -(row_iterator const & it) const { return (m_i - it.m_i) * direction; }
+
+			/// @brief Equality operator
+			/// @return true if operator are equals, else false
+			bool operator ==(row_iterator const & it) const { return (p_data == it.p_data && m_i == it.m_i); }
+
+			/// @brief Not equality operator
+			/// @return true if operator are not equals, else false
+			bool operator !=(row_iterator const & it) const { return ! (*this == it); }
+
+			/// @brief < operator
+			bool operator <(row_iterator const & it) const { return (*this - it) < 0; }
+
+			/// @brief > operator
+			bool operator >(row_iterator const & it) const { return (*this - it) > 0; }
+
+			/// @brief <= operator
+			bool operator <=(row_iterator const & it) const { return (*this - it) <= 0; }
+
+			/// @brief >= operator
+			bool operator >=(row_iterator const & it) const { return (*this - it) >= 0; }
 		};
 
 		/// Iterator
-		using iterator = hnc::iterator<line_ptr<T>, std::vector<line_ptr<T>>>;
+		using iterator = row_iterator<line_ptr<T>, T *, 1>;
 
 		/// Const iterator
-		using const_iterator = hnc::const_iterator<line_const_ptr<T>, std::vector<line_const_ptr<T>>>;
+		using const_iterator = row_iterator<line_const_ptr<T>, T const *, 1>;
 
 		/// Reverse iterator
-		using reverse_iterator = hnc::reverse_iterator<line_ptr<T>, std::vector<line_ptr<T>>>;
+		using reverse_iterator = row_iterator<line_ptr<T>, T *, -1>;
 
 		/// Const reverse iterator
-		using const_reverse_iterator = hnc::const_reverse_iterator<line_const_ptr<T>, std::vector<line_const_ptr<T>>>;
+		using const_reverse_iterator = row_iterator<line_const_ptr<T>, T const *, -1>;
+
+		/// Storage (std::vector<T> with the default alignment)
+		using storage_t = typename std::conditional
+		<
+			(alignment <= alignof(T)),
+			std::vector<T>,
+			std::vector<T, hnc::aligned_allocator<T, alignment>>
+		>::type;
 
 	private:
 
 		/// Data
-		std::vector<T> m_data;
+		storage_t m_data;
 
 		/// Number of rows
 		std::size_t m_nb_row;
@@ -308,11 +476,8 @@ namespace hnc
 		/// Number of columns
 		std::size_t m_nb_col;
 
-		/// Const lignes
-		std::vector<line_const_ptr<T>> m_lines_const_ptr;
-
-		/// Lignes
-		std::vector<line_ptr<T>> m_lines_ptr;
+		/// Number of elements between the beginning of two rows
+		std::size_t m_stride;
 
 	public:
 
@@ -321,31 +486,24 @@ namespace hnc
 		/// @param[in] nb_col        Number of columns
 		/// @param[in] default_value Default value (T() by default)
 		vector2D(std::size_t const nb_row = 0, std::size_t const nb_col = 0, T const & default_value = T()) :
-			m_data(nb_row * nb_col, default_value),
+			m_data(nb_row * compute_stride(nb_col), default_value),
 			m_nb_row(nb_row),
-			m_nb_col(nb_col)
-		{
-			update_lines_ptr();
-		}
+			m_nb_col(nb_col),
+			m_stride(compute_stride(nb_col))
+		{ }
 
 		/// @brief Constructor by copy
-		/// @param[in] v2D A vector2D
-		vector2D(vector2D<T> const & v2D) :
-			m_data(v2D.m_data),
-			m_nb_row(v2D.nb_row()),
-			m_nb_col(v2D.nb_col())
-		{
-			update_lines_ptr();
-		}
+		vector2D(vector2D const &) = default;
 
 		/// @brief Constructor by RValues reference
-		/// @param[in] v2D A vector2D (will be destroyed)
-		vector2D(vector2D<T> && v2D) :
-			m_data(v2D.m_data), m_nb_row(v2D.m_nb_row), m_nb_col(v2D.m_nb_col)
+		/// @param[in] v2D A vector2D (will be empty)
+		vector2D(vector2D && v2D) :
+			m_data(std::move(v2D.m_data)), m_nb_row(v2D.m_nb_row), m_nb_col(v2D.m_nb_col), m_stride(v2D.m_stride)
 		{
+			v2D.m_data.clear();
 			v2D.m_nb_col = 0;
 			v2D.m_nb_row = 0;
-			update_lines_ptr();
+			v2D.m_stride = 0;
 		}
 
 		/**
@@ -407,9 +565,22 @@ namespace hnc
 		/// @return the number of columns
 		std::size_t nb_col() const { return m_nb_col; }
 
+		/// @brief Return the number of elements between the beginning of two rows
+		/// @return the stride (nb_col() with the default alignment)
+		std::size_t stride() const { return m_stride; }
+
+		/// @brief Return a pointer to the data (row after row, stride() elements per row)
+		/// @return a pointer to the first element
+		T const * data() const { return m_data.data(); }
+
+		/// @brief Return a pointer to the data (row after row, stride() elements per row)
+		/// @return a pointer to the first element
+		T * data() { return m_data.data(); }
+
 		/// @brief Move assignment operator between two vector2D
-		/// @param[in] v2D A vector2D
-		vector2D<T> operator =(vector2D<T> && v2D)
+		/// @param[in] v2D A vector2D (will be empty)
+		/// @return the vector2D
+		vector2D & operator =(vector2D && v2D)
 		{
 			// If it is a different vector2D
 			if (this != &v2D)
@@ -418,35 +589,24 @@ namespace hnc
 				m_data = std::move(v2D.m_data);
 				m_nb_row = v2D.m_nb_row;
 				m_nb_col = v2D.m_nb_col;
-				update_lines_ptr();
+				m_stride = v2D.m_stride;
 				// Remove original object
+				v2D.m_data.clear();
 				v2D.m_nb_col = 0;
 				v2D.m_nb_row = 0;
+				v2D.m_stride = 0;
 			}
 			// Return
 			return *this;
 		}
 
 		/// @brief Affectation operator between two vector2D
-		/// @param[in] v2D A vector2D
-		vector2D<T> operator =(vector2D<T> const & v2D)
-		{
-			// If it is a different vector2D
-			if (this != &v2D)
-			{
-				m_data = v2D.m_data;
-				m_nb_row = v2D.nb_row();
-				m_nb_col = v2D.nb_col();
-				update_lines_ptr();
-			}
-			// Return
-			return *this;
-		}
+		vector2D & operator =(vector2D const &) = default;
 		
 		hnc_generate_serialize_member_function(m_data, m_nb_row, m_nb_col)
 		
 		/// @brief After load serialization
-		void after_load_serialization() { update_lines_ptr(); }
+		void after_load_serialization() { m_stride = compute_stride(m_nb_col); }
 
 		// operator () acces
 
@@ -456,7 +616,7 @@ namespace hnc
 		/// @return the value at (i, j)
 		T const & operator()(std::size_t const i, std::size_t const j) const
 		{
-			return m_data[index2D::index1D(i, j, m_nb_col)];
+			return m_data[i * m_stride + j];
 		}
 		
 		/// @brief Acces by fonctor
@@ -465,7 +625,7 @@ namespace hnc
 		/// @return the value at (i, j)
 		T & operator()(std::size_t const i, std::size_t const j)
 		{
-			return m_data[index2D::index1D(i, j, m_nb_col)];
+			return m_data[i * m_stride + j];
 		}
 
 		// .at acces
@@ -473,73 +633,75 @@ namespace hnc
 		/// @brief Safe const acces
 		/// @param i Row index
 		/// @param j Column index
-		/// @exception std::out_of_range if out of range access (check by std::vector)
+		/// @exception std::out_of_range if out of range access
 		/// @return the value at .at(i, j)
 		T const & at(std::size_t const i, std::size_t const j) const
 		{
-			return m_data.at(index2D::index1D(i, j, m_nb_col));
+			check_range(i, j);
+			return (*this)(i, j);
 		}
 		
 		/// @brief Safe acces
 		/// @param i Row index
 		/// @param j Column index
-		/// @exception std::out_of_range if out of range access (check by std::vector)
+		/// @exception std::out_of_range if out of range access
 		/// @return the value at .at(i, j)
 		T & at(std::size_t const i, std::size_t const j)
 		{
-			return m_data.at(index2D::index1D(i, j, m_nb_col));
+			check_range(i, j);
+			return (*this)(i, j);
 		}
 
 		// operator [] access
 
 		/// @brief Const access by [i][j]
 		/// @param i Row index
-		/// @return a proxy to have [j]
-		hnc::vector2D<T>::line_const_ptr<T> const & operator[](std::size_t const i) const
+		/// @return a view of the row to have [j]
+		line_const_ptr<T> operator[](std::size_t const i) const
 		{
-			return m_lines_const_ptr[i];
+			return line_const_ptr<T>(m_data.data() + i * m_stride, m_nb_col);
 		}
 		
 		/// @brief Acces by [i][j]
 		/// @param i Row index
-		/// @return a proxy to have [j]
-		hnc::vector2D<T>::line_ptr<T> & operator[](std::size_t const i)
+		/// @return a view of the row to have [j]
+		line_ptr<T> operator[](std::size_t const i)
 		{
-			return m_lines_ptr[i];
+			return line_ptr<T>(m_data.data() + i * m_stride, m_nb_col);
 		}
 		
 		// front, back
 
 		/// @brief Const access to the first line
 		/// @pre vector2D has at least one line
-		/// @return a proxy to have the first line
-		hnc::vector2D<T>::line_const_ptr<T> const & front() const
+		/// @return a view of the first line
+		line_const_ptr<T> front() const
 		{
-			return m_lines_const_ptr[0];
+			return (*this)[0];
 		}
 		
 		/// @brief Access to the first line
 		/// @pre vector2D has at least one line
-		/// @return a proxy to have the first line
-		hnc::vector2D<T>::line_ptr<T> & front()
+		/// @return a view of the first line
+		line_ptr<T> front()
 		{
-			return m_lines_ptr[0];
+			return (*this)[0];
 		}
 
 		/// @brief Const access to the last line
 		/// @pre vector2D has at least one line
-		/// @return a proxy to have the last line
-		hnc::vector2D<T>::line_const_ptr<T> const & back() const
+		/// @return a view of the last line
+		line_const_ptr<T> back() const
 		{
-			return m_lines_const_ptr[m_nb_row - 1];
+			return (*this)[m_nb_row - 1];
 		}
 		
 		/// @brief Access to the last line
 		/// @pre vector2D has at least one line
-		/// @return a proxy to have the last line
-		hnc::vector2D<T>::line_ptr<T> & back()
+		/// @return a view of the last line
+		line_ptr<T> back()
 		{
-			return m_lines_ptr[m_nb_row - 1];
+			return (*this)[m_nb_row - 1];
 		}
 		
 		// Iterator
@@ -548,42 +710,42 @@ namespace hnc
 		/// @return a iterator to the beginning
 		iterator begin()
 		{
-			return iterator(m_lines_ptr, 0);
+			return iterator(m_data.data(), m_stride, m_nb_col, 0);
 		}
 
 		/// @brief Return a iterator to the end
 		/// @return a iterator to the end
 		iterator end()
 		{
-			return iterator(m_lines_ptr, nb_row());
+			return iterator(m_data.data(), m_stride, m_nb_col, std::ptrdiff_t(m_nb_row));
 		}
 		
 		/// @brief Return a const iterator to the beginning
 		/// @return a const iterator to the beginning
 		const_iterator begin() const
 		{
-			return const_iterator(m_lines_const_ptr, 0);
+			return const_iterator(m_data.data(), m_stride, m_nb_col, 0);
 		}
 
 		/// @brief Return a const iterator to the end
 		/// @return a const iterator to the end
 		const_iterator end() const
 		{
-			return const_iterator(m_lines_const_ptr, nb_row());
+			return const_iterator(m_data.data(), m_stride, m_nb_col, std::ptrdiff_t(m_nb_row));
 		}
 		
 		/// @brief Return a const iterator to the beginning
 		/// @return a const iterator to the beginning
 		const_iterator cbegin() const
 		{
-			return const_iterator(m_lines_const_ptr, 0);
+			return begin();
 		}
 
 		/// @brief Return a const iterator to the end
 		/// @return a const iterator to the end
 		const_iterator cend() const
 		{
-			return const_iterator(m_lines_const_ptr, nb_row());
+			return end();
 		}
 		
 		// Reverse iterator
@@ -592,42 +754,42 @@ namespace hnc
 		/// @return a reverse iterator to the beginning
 		reverse_iterator rbegin()
 		{
-			return reverse_iterator(m_lines_ptr, nb_row() - 1);
+			return reverse_iterator(m_data.data(), m_stride, m_nb_col, std::ptrdiff_t(m_nb_row) - 1);
 		}
 
 		/// @brief Return a reverse iterator to the end
 		/// @return a reverse iterator to the end
 		reverse_iterator rend()
 		{
-			return reverse_iterator(m_lines_ptr, 0);
+			return reverse_iterator(m_data.data(), m_stride, m_nb_col, -1);
 		}
 
 		/// @brief Return a const reverse iterator to the beginning
 		/// @return a const reverse iterator to the beginning
 		const_reverse_iterator rbegin() const
 		{
-			return const_reverse_iterator(m_lines_const_ptr, nb_row() - 1);
+			return const_reverse_iterator(m_data.data(), m_stride, m_nb_col, std::ptrdiff_t(m_nb_row) - 1);
 		}
 
 		/// @brief Return a const reverse iterator to the end
 		/// @return a const reverse iterator to the end
 		const_reverse_iterator rend() const
 		{
-			return const_reverse_iterator(m_lines_const_ptr, 0);
+			return const_reverse_iterator(m_data.data(), m_stride, m_nb_col, -1);
 		}
 
 		/// @brief Return a const reverse iterator to the beginning
 		/// @return a const reverse iterator to the beginning
 		const_reverse_iterator crbegin() const
 		{
-			return const_reverse_iterator(m_lines_const_ptr, nb_row() - 1);
+			return rbegin();
 		}
 
 		/// @brief Return a const reverse iterator to the end
 		/// @return a const reverse iterator to the end
 		const_reverse_iterator crend() const
 		{
-			return const_reverse_iterator(m_lines_const_ptr, 0);
+			return rend();
 		}
 
 		// Operator
@@ -635,23 +797,33 @@ namespace hnc
 		/// @brief Equality operator
 		/// @param[in] v A hnc::vector2D<T> for the comparaison
 		/// @return true if hnc::vector2D<T> are equals, false otherwise
-		bool operator ==(hnc::vector2D<T> const & v) const
+		bool operator ==(vector2D const & v) const
 		{
 			// Different size
 			if (this->nb_row() != v.nb_row() || this->nb_col() != v.nb_col())
 			{
 				return false;
 			}
-			else
+			// Contiguous
+			else if (m_stride == m_nb_col)
 			{
 				return (m_data == v.m_data);
 			}
+			// Compare row by row (without the padding)
+			else
+			{
+				for (std::size_t row = 0; row < m_nb_row; ++row)
+				{
+					if (! std::equal((*this)[row].begin(), (*this)[row].end(), v[row].begin())) { return false; }
+				}
+				return true;
+			}
 		}
 
 		/// @brief Inequality operator
 		/// @param[in] v A hnc::vector2D<T> for the comparaison
 		/// @return true if hnc::vector2D<T> are not equals, false otherwise
-		bool operator !=(hnc::vector2D<T> const & v) const
+		bool operator !=(vector2D const & v) const
 		{
 			return ! (*this == v);
 		}
@@ -669,7 +841,7 @@ namespace hnc
 				hnc::hassert(i <= m_nb_row, std::out_of_range("hnc::vector2D::add_row_before could not insert before row " + hnc::to_string(i) + ", number of rows = " + hnc::to_string(m_nb_row)));
 			#endif
 			// New vector2D
-			hnc::vector2D<T> new_vector2D(m_nb_row + 1, m_nb_col);
+			vector2D new_vector2D(m_nb_row + 1, m_nb_col);
 			// Copy rows before new row
 			for (std::size_t row = 0; row < i; ++row)
 			{
@@ -706,7 +878,7 @@ namespace hnc
 				hnc::hassert(j <= m_nb_col, std::out_of_range("hnc::vector2D::add_col_before could not insert before column " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col)));
 			#endif
 			// New vector2D
-			hnc::vector2D<T> new_vector2D(m_nb_row, m_nb_col + 1);
+			vector2D new_vector2D(m_nb_row, m_nb_col + 1);
 			// Copy rows before new row
 			for (std::size_t row = 0; row < m_nb_row; ++row)
 			{
@@ -741,7 +913,7 @@ namespace hnc
 				hnc::hassert(i < m_nb_row, std::out_of_range("hnc::vector2D::remove_line could not remove the line " + hnc::to_string(i) + ", number of rows = " + hnc::to_string(m_nb_row)));
 			#endif
 			// New vector2D
-			hnc::vector2D<T> new_vector2D(m_nb_row - 1, m_nb_col);
+			vector2D new_vector2D(m_nb_row - 1, m_nb_col);
 			// Copy lines before i
 			for (std::size_t row = 0; row < i; ++row)
 			{
@@ -768,7 +940,7 @@ namespace hnc
 				hnc::hassert(j < m_nb_col, std::out_of_range("hnc::vector2D::remove_column could not remove the column " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col)));
 			#endif
 			// New vector2D
-			hnc::vector2D<T> new_vector2D(m_nb_row, m_nb_col - 1);
+			vector2D new_vector2D(m_nb_row, m_nb_col - 1);
 			// Copy lines
 			for (std::size_t row = 0; row < m_nb_row; ++row)
 			{
@@ -789,6 +961,22 @@ namespace hnc
 
 	private:
 
+		/// @brief Return the stride of a row
+		/// @param[in] nb_col Number of columns
+		/// @return the smallest stride >= nb_col such that each row starts on a multiple of alignment bytes
+		static std::size_t compute_stride(std::size_t const nb_col)
+		{
+			if (alignment <= alignof(T)) { return nb_col; }
+			
+			// The stride must be a multiple of alignment / gcd(alignment, sizeof(T)) elements
+			std::size_t a = alignment;
+			std::size_t b = sizeof(T);
+			while (b != 0) { std::size_t const r = a % b; a = b; b = r; }
+			std::size_t const unit = alignment / a;
+			
+			return (nb_col + unit - 1) / unit * unit;
+		}
+
 		#ifndef NDEBUG
 			/**
 			 * @brief Check if acces is out of range with hnc::hassert if NDEBUG is not defined
@@ -823,26 +1011,14 @@ namespace hnc
 				throw std::out_of_range("hnc::vector2D, id column = " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col));
 			}
 		}
-
-		/// @brief Udapte lines const and lines after each modifications of the vector2D (constructors, operator =, add/remove line/column)
-		void update_lines_ptr()
-		{
-			m_lines_const_ptr.resize(nb_row());
-			m_lines_ptr.resize(nb_row());
-			for (std::size_t row = 0; row < m_nb_row; ++row)
-			{
-				m_lines_const_ptr[row] = line_const_ptr<T>(this, row);
-				m_lines_ptr[row] = line_ptr<T>(this, row);
-			}
-		}
 	};
 	
 	/// @brief Operator << between a std::ostream and a hnc::vector2D<T>
 	/// @param[in,out] o Output stream
 	/// @param[in]     v A hnc::vector2D<T>
 	/// @return the output stream
-	template <class T>
-	std::ostream & operator <<(std::ostream & o, hnc::vector2D<T> const & v)
+	template <class T, std::size_t alignment>
+	std::ostream & operator <<(std::ostream & o, hnc::vector2D<T, alignment> const & v)
 	{
 		// Display data
 		for (std::size_t row = 0; row < v.nb_row(); ++row)
@@ -0,0 +1,592 @@
+// Copyright © 2012-2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HNC_VECTOR2D_GROWABLE_HPP
+#define HNC_VECTOR2D_GROWABLE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "vector2D.hpp"
+#include "assert.hpp"
+#include "to_string.hpp"
+
+
+namespace hnc
+{
+	/**
+	 * @brief 2D container (like hnc::vector2D) with a capacity in both dimensions and free space on the four sides
+	 *
+	 * @code
+	   #include <hnc/vector2D_growable.hpp>
+	   @endcode
+	 *
+	 * The values are stored in a row_capacity() x col_capacity() buffer, the element (0, 0) is not at the beginning of the buffer. @n
+	 * When a side has no more free space, the buffer grows geometrically and the free space is shared between the two sides,
+	 * so adding rows (or columns) at one edge is amortized O(nb_col()) (or O(nb_row())) per row (or column). @n
+	 * An insertion (or a removal) inside moves only the smaller part (before or after the position).
+	 *
+	 * The bulk operations on columns (insert, remove, reallocation) work row by row and run in parallel with OpenMP
+	 * when there are at least parallel_threshold values to move.
+	 *
+	 * Use it for grids which grow at the edges (maps built while exploring), else hnc::vector2D is simpler.
+	 *
+	 * @code
+	   hnc::vector2D_growable<int> grid(2, 3, 0);
+	   grid.add_cols_front(4, -1); // O(nb_row())
+	   grid.add_rows_back(1, 42);  // O(nb_col())
+	   hnc::vector2D<int> v = grid.to_vector2D();
+	   @endcode
+	 */
+	template <class T>
+	class vector2D_growable
+	{
+	public:
+
+		/// Proxy class for a line
+		using line_ptr = typename hnc::vector2D<T>::template line_ptr<T>;
+
+		/// Proxy class for a const line
+		using line_const_ptr = typename hnc::vector2D<T>::template line_const_ptr<T>;
+
+		/// Iterator on the rows
+		using iterator = typename hnc::vector2D<T>::template row_iterator<line_ptr, T *, 1>;
+
+		/// Const iterator on the rows
+		using const_iterator = typename hnc::vector2D<T>::template row_iterator<line_const_ptr, T const *, 1>;
+
+		/// Minimum number of values moved to use OpenMP
+		static constexpr std::size_t parallel_threshold = 1 << 16;
+
+	private:
+
+		/// Data (m_row_capacity x m_col_capacity)
+		std::vector<T> m_data;
+
+		/// Number of rows in the buffer
+		std::size_t m_row_capacity;
+
+		/// Number of columns in the buffer
+		std::size_t m_col_capacity;
+
+		/// Row of the element (0, 0) in the buffer
+		std::size_t m_row_begin;
+
+		/// Column of the element (0, 0) in the buffer
+		std::size_t m_col_begin;
+
+		/// Number of rows
+		std::size_t m_nb_row;
+
+		/// Number of columns
+		std::size_t m_nb_col;
+
+	public:
+
+		/// @brief Constructor
+		/// @param[in] nb_row        Number of rows
+		/// @param[in] nb_col        Number of columns
+		/// @param[in] default_value Default value (T() by default)
+		vector2D_growable(std::size_t const nb_row = 0, std::size_t const nb_col = 0, T const & default_value = T()) :
+			m_data(nb_row * nb_col, default_value),
+			m_row_capacity(nb_row),
+			m_col_capacity(nb_col),
+			m_row_begin(0),
+			m_col_begin(0),
+			m_nb_row(nb_row),
+			m_nb_col(nb_col)
+		{ }
+
+		/// @brief Constructor from a hnc::vector2D
+		/// @param[in] v2D A hnc::vector2D
+		template <std::size_t alignment>
+		explicit vector2D_growable(hnc::vector2D<T, alignment> const & v2D) :
+			vector2D_growable(v2D.nb_row(), v2D.nb_col())
+		{
+			for (std::size_t row = 0; row < m_nb_row; ++row)
+			{
+				std::copy(v2D[row].begin(), v2D[row].end(), (*this)[row].begin());
+			}
+		}
+
+		/// @brief Return the number of rows
+		/// @return the number of rows
+		std::size_t nb_row() const { return m_nb_row; }
+
+		/// @brief Return the number of rows
+		/// @return the number of rows
+		std::size_t size() const { return nb_row(); }
+
+		/// @brief Return the number of columns
+		/// @return the number of columns
+		std::size_t nb_col() const { return m_nb_col; }
+
+		/// @brief Return the number of rows which can be stored without reallocation
+		/// @return the number of rows in the buffer
+		std::size_t row_capacity() const { return m_row_capacity; }
+
+		/// @brief Return the number of columns which can be stored without reallocation
+		/// @return the number of columns in the buffer
+		std::size_t col_capacity() const { return m_col_capacity; }
+
+		// Access
+
+		/// @brief Const access by fonctor
+		/// @param i Row index
+		/// @param j Column index
+		/// @return the value at (i, j)
+		T const & operator()(std::size_t const i, std::size_t const j) const
+		{
+			return m_data[(m_row_begin + i) * m_col_capacity + m_col_begin + j];
+		}
+
+		/// @brief Acces by fonctor
+		/// @param i Row index
+		/// @param j Column index
+		/// @return the value at (i, j)
+		T & operator()(std::size_t const i, std::size_t const j)
+		{
+			return m_data[(m_row_begin + i) * m_col_capacity + m_col_begin + j];
+		}
+
+		/// @brief Safe const acces
+		/// @param i Row index
+		/// @param j Column index
+		/// @exception std::out_of_range if out of range access
+		/// @return the value at .at(i, j)
+		T const & at(std::size_t const i, std::size_t const j) const
+		{
+			check_range(i, j);
+			return (*this)(i, j);
+		}
+
+		/// @brief Safe acces
+		/// @param i Row index
+		/// @param j Column index
+		/// @exception std::out_of_range if out of range access
+		/// @return the value at .at(i, j)
+		T & at(std::size_t const i, std::size_t const j)
+		{
+			check_range(i, j);
+			return (*this)(i, j);
+		}
+
+		/// @brief Const access by [i][j]
+		/// @param i Row index
+		/// @return a view of the row to have [j]
+		line_const_ptr operator[](std::size_t const i) const
+		{
+			return line_const_ptr(first() + i * m_col_capacity, m_nb_col);
+		}
+
+		/// @brief Acces by [i][j]
+		/// @param i Row index
+		/// @return a view of the row to have [j]
+		line_ptr operator[](std::size_t const i)
+		{
+			return line_ptr(first() + i * m_col_capacity, m_nb_col);
+		}
+
+		/// @brief Return a iterator to the first row
+		/// @return a iterator to the first row
+		iterator begin() { return iterator(first(), m_col_capacity, m_nb_col, 0); }
+
+		/// @brief Return a iterator to the end
+		/// @return a iterator to the end
+		iterator end() { return iterator(first(), m_col_capacity, m_nb_col, std::ptrdiff_t(m_nb_row)); }
+
+		/// @brief Return a const iterator to the first row
+		/// @return a const iterator to the first row
+		const_iterator begin() const { return const_iterator(first(), m_col_capacity, m_nb_col, 0); }
+
+		/// @brief Return a const iterator to the end
+		/// @return a const iterator to the end
+		const_iterator end() const { return const_iterator(first(), m_col_capacity, m_nb_col, std::ptrdiff_t(m_nb_row)); }
+
+		// Capacity
+
+		/**
+		 * @brief Reserve free space on each side
+		 *
+		 * @param[in] nb_row_front Number of rows which can be added at the front without reallocation
+		 * @param[in] nb_row_back  Number of rows which can be added at the back without reallocation
+		 * @param[in] nb_col_front Number of columns which can be added at the front without reallocation
+		 * @param[in] nb_col_back  Number of columns which can be added at the back without reallocation
+		 */
+		void reserve(std::size_t const nb_row_front, std::size_t const nb_row_back, std::size_t const nb_col_front, std::size_t const nb_col_back)
+		{
+			std::size_t const row_front = std::max(nb_row_front, m_row_begin);
+			std::size_t const row_back = std::max(nb_row_back, m_row_capacity - m_row_begin - m_nb_row);
+			std::size_t const col_front = std::max(nb_col_front, m_col_begin);
+			std::size_t const col_back = std::max(nb_col_back, m_col_capacity - m_col_begin - m_nb_col);
+			
+			if (row_front + m_nb_row + row_back != m_row_capacity || col_front + m_nb_col + col_back != m_col_capacity)
+			{
+				reallocate(row_front + m_nb_row + row_back, col_front + m_nb_col + col_back, row_front, col_front);
+			}
+		}
+
+		/// @brief Remove the free space
+		void shrink_to_fit()
+		{
+			if (m_nb_row != m_row_capacity || m_nb_col != m_col_capacity)
+			{
+				reallocate(m_nb_row, m_nb_col, 0, 0);
+			}
+		}
+
+		// Add rows / columns
+
+		/// @brief Add rows at the front (amortized O(nb_col()) per row)
+		/// @param[in] n             Number of rows
+		/// @param[in] default_value Default value
+		void add_rows_front(std::size_t const n, T const & default_value = T()) { add_rows_before(0, n, default_value); }
+
+		/// @brief Add rows at the back (amortized O(nb_col()) per row)
+		/// @param[in] n             Number of rows
+		/// @param[in] default_value Default value
+		void add_rows_back(std::size_t const n, T const & default_value = T()) { add_rows_before(m_nb_row, n, default_value); }
+
+		/// @brief Add columns at the front (amortized O(nb_row()) per column)
+		/// @param[in] n             Number of columns
+		/// @param[in] default_value Default value
+		void add_cols_front(std::size_t const n, T const & default_value = T()) { add_cols_before(0, n, default_value); }
+
+		/// @brief Add columns at the back (amortized O(nb_row()) per column)
+		/// @param[in] n             Number of columns
+		/// @param[in] default_value Default value
+		void add_cols_back(std::size_t const n, T const & default_value = T()) { add_cols_before(m_nb_col, n, default_value); }
+
+		/// @brief Add a row before
+		/// @param[in] i             Row is inserted before this one
+		/// @param[in] default_value Default value
+		void add_row_before(std::size_t const i, T const & default_value = T()) { add_rows_before(i, 1, default_value); }
+
+		/// @brief Add a row after
+		/// @param[in] i             Row is inserted after this one
+		/// @param[in] default_value Default value
+		void add_row_after(std::size_t const i, T const & default_value = T()) { add_rows_before(i + 1, 1, default_value); }
+
+		/// @brief Add a column before
+		/// @param[in] j             Column is inserted before this one
+		/// @param[in] default_value Default value
+		void add_col_before(std::size_t const j, T const & default_value = T()) { add_cols_before(j, 1, default_value); }
+
+		/// @brief Add a column after
+		/// @param[in] j             Column is inserted after this one
+		/// @param[in] default_value Default value
+		void add_col_after(std::size_t const j, T const & default_value = T()) { add_cols_before(j + 1, 1, default_value); }
+
+		/// @brief Add rows before a row
+		/// @param[in] i             Rows are inserted before this one
+		/// @param[in] n             Number of rows
+		/// @param[in] default_value Default value
+		/// @exception std::out_of_range hnc::hassert i <= number of rows if NDEBUG is not defined
+		void add_rows_before(std::size_t const i, std::size_t const n, T const & default_value = T())
+		{
+			// Check i
+			#ifndef NDEBUG
+				hnc::hassert(i <= m_nb_row, std::out_of_range("hnc::vector2D_growable::add_rows_before could not insert before row " + hnc::to_string(i) + ", number of rows = " + hnc::to_string(m_nb_row)));
+			#endif
+			if (n == 0) { return; }
+			
+			// Free space
+			bool const move_front = (i < m_nb_row - i);
+			if (has_room(move_front, m_nb_row, m_row_begin, m_row_capacity, n) == false)
+			{
+				grow(m_row_capacity, m_nb_row, n, i, m_col_capacity, m_col_begin, true);
+				return add_rows_before(i, n, default_value);
+			}
+			
+			// Move the rows before (or after) i, the rows are contiguous in the buffer
+			T * const begin = m_data.data() + m_row_begin * m_col_capacity;
+			if (move_front)
+			{
+				std::move(begin, begin + i * m_col_capacity, begin - n * m_col_capacity);
+				m_row_begin -= n;
+			}
+			else
+			{
+				std::move_backward(begin + i * m_col_capacity, begin + m_nb_row * m_col_capacity, begin + (m_nb_row + n) * m_col_capacity);
+			}
+			m_nb_row += n;
+			
+			// New rows
+			for (std::size_t row = i; row < i + n; ++row)
+			{
+				std::fill((*this)[row].begin(), (*this)[row].end(), default_value);
+			}
+		}
+
+		/// @brief Add columns before a column (rows are processed in parallel)
+		/// @param[in] j             Columns are inserted before this one
+		/// @param[in] n             Number of columns
+		/// @param[in] default_value Default value
+		/// @exception std::out_of_range hnc::hassert j <= number of columns if NDEBUG is not defined
+		void add_cols_before(std::size_t const j, std::size_t const n, T const & default_value = T())
+		{
+			// Check j
+			#ifndef NDEBUG
+				hnc::hassert(j <= m_nb_col, std::out_of_range("hnc::vector2D_growable::add_cols_before could not insert before column " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col)));
+			#endif
+			if (n == 0) { return; }
+			
+			// Free space
+			bool const move_front = (j < m_nb_col - j);
+			if (has_room(move_front, m_nb_col, m_col_begin, m_col_capacity, n) == false)
+			{
+				grow(m_col_capacity, m_nb_col, n, j, m_row_capacity, m_row_begin, false);
+				return add_cols_before(j, n, default_value);
+			}
+			
+			// Move the columns before (or after) j in each row
+			std::size_t const nb_row = m_nb_row;
+			std::size_t const nb_col = m_nb_col;
+			T * const first_row = first();
+			std::size_t const col_capacity = m_col_capacity;
+			#pragma omp parallel for if (nb_row * (std::min(j, nb_col - j) + n) >= parallel_threshold)
+			for (long int row = 0; row < long(nb_row); ++row)
+			{
+				T * const p = first_row + std::size_t(row) * col_capacity;
+				if (move_front)
+				{
+					std::move(p, p + j, p - n);
+					std::fill(p + j - n, p + j, default_value);
+				}
+				else
+				{
+					std::move_backward(p + j, p + nb_col, p + nb_col + n);
+					std::fill(p + j, p + j + n, default_value);
+				}
+			}
+			if (move_front) { m_col_begin -= n; }
+			m_nb_col += n;
+		}
+
+		// Remove rows / columns
+
+		/// @brief Remove a line
+		/// @param[in] i Row removed
+		void remove_line(std::size_t const i) { remove_rows(i, 1); }
+
+		/// @brief Remove a column
+		/// @param[in] j Column removed
+		void remove_column(std::size_t const j) { remove_cols(j, 1); }
+
+		/// @brief Remove rows
+		/// @param[in] i First row removed
+		/// @param[in] n Number of rows removed
+		/// @exception std::out_of_range hnc::hassert i + n <= number of rows if NDEBUG is not defined
+		void remove_rows(std::size_t const i, std::size_t const n)
+		{
+			// Check i
+			#ifndef NDEBUG
+				hnc::hassert(i + n <= m_nb_row, std::out_of_range("hnc::vector2D_growable::remove_rows could not remove " + hnc::to_string(n) + " rows from row " + hnc::to_string(i) + ", number of rows = " + hnc::to_string(m_nb_row)));
+			#endif
+			if (n == 0) { return; }
+			
+			// Move the smaller part
+			T * const begin = m_data.data() + m_row_begin * m_col_capacity;
+			if (i < m_nb_row - i - n)
+			{
+				std::move_backward(begin, begin + i * m_col_capacity, begin + (i + n) * m_col_capacity);
+				m_row_begin += n;
+			}
+			else
+			{
+				std::move(begin + (i + n) * m_col_capacity, begin + m_nb_row * m_col_capacity, begin + i * m_col_capacity);
+			}
+			m_nb_row -= n;
+		}
+
+		/// @brief Remove columns (rows are processed in parallel)
+		/// @param[in] j First column removed
+		/// @param[in] n Number of columns removed
+		/// @exception std::out_of_range hnc::hassert j + n <= number of columns if NDEBUG is not defined
+		void remove_cols(std::size_t const j, std::size_t const n)
+		{
+			// Check j
+			#ifndef NDEBUG
+				hnc::hassert(j + n <= m_nb_col, std::out_of_range("hnc::vector2D_growable::remove_cols could not remove " + hnc::to_string(n) + " columns from column " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col)));
+			#endif
+			if (n == 0) { return; }
+			
+			// Move the smaller part of each row
+			bool const move_front = (j < m_nb_col - j - n);
+			std::size_t const nb_row = m_nb_row;
+			std::size_t const nb_col = m_nb_col;
+			T * const first_row = first();
+			std::size_t const col_capacity = m_col_capacity;
+			#pragma omp parallel for if (nb_row * std::min(j, nb_col - j - n) >= parallel_threshold)
+			for (long int row = 0; row < long(nb_row); ++row)
+			{
+				T * const p = first_row + std::size_t(row) * col_capacity;
+				if (move_front) { std::move_backward(p, p + j, p + j + n); }
+				else { std::move(p + j + n, p + nb_col, p + j); }
+			}
+			if (move_front) { m_col_begin += n; }
+			m_nb_col -= n;
+		}
+
+		// Conversion
+
+		/// @brief Return a hnc::vector2D with the same values
+		/// @return a hnc::vector2D with the same values
+		hnc::vector2D<T> to_vector2D() const
+		{
+			hnc::vector2D<T> v2D(m_nb_row, m_nb_col);
+			for (std::size_t row = 0; row < m_nb_row; ++row)
+			{
+				std::copy((*this)[row].begin(), (*this)[row].end(), v2D[row].begin());
+			}
+			return v2D;
+		}
+
+		// Operator
+
+		/// @brief Equality operator
+		/// @param[in] v A hnc::vector2D_growable<T> for the comparaison
+		/// @return true if hnc::vector2D_growable<T> are equals, false otherwise
+		bool operator ==(vector2D_growable const & v) const
+		{
+			if (m_nb_row != v.m_nb_row || m_nb_col != v.m_nb_col) { return false; }
+			for (std::size_t row = 0; row < m_nb_row; ++row)
+			{
+				if (! std::equal((*this)[row].begin(), (*this)[row].end(), v[row].begin())) { return false; }
+			}
+			return true;
+		}
+
+		/// @brief Inequality operator
+		/// @param[in] v A hnc::vector2D_growable<T> for the comparaison
+		/// @return true if hnc::vector2D_growable<T> are not equals, false otherwise
+		bool operator !=(vector2D_growable const & v) const
+		{
+			return ! (*this == v);
+		}
+
+	private:
+
+		/// @brief Return a pointer to the element (0, 0) in the buffer
+		/// @return a pointer to the element (0, 0)
+		T * first() { return m_data.data() + m_row_begin * m_col_capacity + m_col_begin; }
+
+		/// @brief Return a const pointer to the element (0, 0) in the buffer
+		/// @return a const pointer to the element (0, 0)
+		T const * first() const { return m_data.data() + m_row_begin * m_col_capacity + m_col_begin; }
+
+		/**
+		 * @brief Check if there is enough free space to insert n elements in one dimension
+		 * @param[in] front    true to check the front, false to check the back
+		 * @param[in] size     Number of elements
+		 * @param[in] begin    First element in the buffer
+		 * @param[in] capacity Size of the buffer
+		 * @param[in] n        Number of inserted elements
+		 * @return true if n elements can be inserted on this side, false otherwise
+		 */
+		static bool has_room(bool const front, std::size_t const size, std::size_t const begin, std::size_t const capacity, std::size_t const n)
+		{
+			return (front) ? (begin >= n) : (capacity - begin - size >= n);
+		}
+
+		/**
+		 * @brief Grow the buffer in one dimension to insert n elements before the position k
+		 *
+		 * The new capacity is at least twice the new size, the free space is shared between the front and the back
+		 * (when the buffer is big enough, the values are only moved to the middle).
+		 *
+		 * @param[in] capacity       Capacity of the dimension which grows
+		 * @param[in] size           Number of elements of the dimension which grows
+		 * @param[in] n              Number of inserted elements
+		 * @param[in] k              Position of the insertion
+		 * @param[in] other_capacity Capacity of the other dimension
+		 * @param[in] other_begin    First element of the other dimension
+		 * @param[in] rows           true if the rows grow, false if the columns grow
+		 */
+		void grow
+		(
+			std::size_t const capacity, std::size_t const size,
+			std::size_t const n, std::size_t const k,
+			std::size_t const other_capacity, std::size_t const other_begin,
+			bool const rows
+		)
+		{
+			std::size_t const new_capacity = std::max(2 * (size + n), capacity);
+			std::size_t const free_space = new_capacity - size - n;
+			// The side where the elements will move has n more free elements
+			std::size_t const new_begin = free_space / 2 + ((k < size - k) ? n : 0);
+			if (rows) { reallocate(new_capacity, other_capacity, new_begin, other_begin); }
+			else { reallocate(other_capacity, new_capacity, other_begin, new_begin); }
+		}
+
+		/**
+		 * @brief Move the values in a new buffer (rows are processed in parallel)
+		 * @param[in] row_capacity Number of rows of the new buffer
+		 * @param[in] col_capacity Number of columns of the new buffer
+		 * @param[in] row_begin    Row of the element (0, 0) in the new buffer
+		 * @param[in] col_begin    Column of the element (0, 0) in the new buffer
+		 */
+		void reallocate(std::size_t const row_capacity, std::size_t const col_capacity, std::size_t const row_begin, std::size_t const col_begin)
+		{
+			std::vector<T> data(row_capacity * col_capacity);
+			
+			std::size_t const nb_row = m_nb_row;
+			std::size_t const nb_col = m_nb_col;
+			T * const src = first();
+			T * const dst = data.data() + row_begin * col_capacity + col_begin;
+			std::size_t const src_stride = m_col_capacity;
+			#pragma omp parallel for if (nb_row * nb_col >= parallel_threshold)
+			for (long int row = 0; row < long(nb_row); ++row)
+			{
+				T * const p = src + std::size_t(row) * src_stride;
+				std::move(p, p + nb_col, dst + std::size_t(row) * col_capacity);
+			}
+			
+			m_data = std::move(data);
+			m_row_capacity = row_capacity;
+			m_col_capacity = col_capacity;
+			m_row_begin = row_begin;
+			m_col_begin = col_begin;
+		}
+
+		/// @brief Check if acces is out of range
+		/// @param i Row index
+		/// @param j Column index
+		void check_range(std::size_t const i, std::size_t const j) const
+		{
+			if (i >= m_nb_row)
+			{
+				throw std::out_of_range("hnc::vector2D_growable, id row = " + hnc::to_string(i) + ", number of rows = " + hnc::to_string(m_nb_row));
+			}
+			if (j >= m_nb_col)
+			{
+				throw std::out_of_range("hnc::vector2D_growable, id column = " + hnc::to_string(j) + ", number of columns = " + hnc::to_string(m_nb_col));
+			}
+		}
+	};
+
+	/// @brief Operator << between a std::ostream and a hnc::vector2D_growable<T>
+	/// @param[in,out] o Output stream
+	/// @param[in]     v A hnc::vector2D_growable<T>
+	/// @return the output stream
+	template <class T>
+	std::ostream & operator <<(std::ostream & o, hnc::vector2D_growable<T> const & v)
+	{
+		return o << v.to_vector2D();
+	}
+}
+
+#endif
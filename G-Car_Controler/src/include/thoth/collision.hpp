@@ -19,13 +19,47 @@
 #ifndef THOTH_COLLISION_HPP
 #define THOTH_COLLISION_HPP
 
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
 #include <hnc/geometry.hpp>
+#include <hnc/vector2D.hpp>
+#include <hnc/color.hpp>
 
 #include "sprite.hpp"
 
 
 namespace thoth
 {
+	/**
+	 * @brief Collision between two rectangles
+	 * 
+	 * @code
+	   #include <thoth/collision.hpp>
+	   @endcode
+	 * 
+	 * @param[in] bounds_a A hnc::geometry::rectangle
+	 * @param[in] bounds_b A hnc::geometry::rectangle
+	 * 
+	 * @return true if the rectangles overlap (or touch), false otherwise
+	 */
+	template <class T>
+	bool collision(hnc::geometry::rectangle<T> const & bounds_a, hnc::geometry::rectangle<T> const & bounds_b)
+	{
+		return
+		(
+			bounds_a.left <= bounds_b.left + bounds_b.width &&
+			bounds_b.left <= bounds_a.left + bounds_a.width &&
+			bounds_a.top <= bounds_b.top + bounds_b.height &&
+			bounds_b.top <= bounds_a.top + bounds_a.height
+		);
+	}
+	
 	/**
 	 * @brief Collision
 	 * 
@@ -44,38 +78,198 @@ namespace thoth
 	 */
 	inline bool collision(thoth::sprite const & sprite_a, thoth::sprite const & sprite_b)
 	{
-		using hnc::geometry::is_in_rectangle;
+		return thoth::collision(sprite_a.bounds_global(), sprite_b.bounds_global());
+	}
+	
+	/**
+	 * @brief Opaque pixels of an image, one bit per pixel
+	 * 
+	 * @code
+	   #include <thoth/collision.hpp>
+	   @endcode
+	 * 
+	 * The bits are stored row by row (y), 64 pixels (x) per word.
+	 */
+	class collision_mask
+	{
+	private:
 		
-		auto const bounds_a = sprite_a.bounds_global();
-		auto const bounds_b = sprite_b.bounds_global();
+		/// Width (in pixels)
+		std::size_t m_width;
+		
+		/// Height (in pixels)
+		std::size_t m_height;
+		
+		/// Number of words per row
+		std::size_t m_nb_word;
 		
-		// In bounds_a
+		/// Bits
+		std::vector<std::uint64_t> m_bits;
 		
-		if (is_in_rectangle(bounds_b.left, bounds_b.top, bounds_a)) { return true; }
+	public:
 		
-		if (is_in_rectangle(bounds_b.left + bounds_b.width, bounds_b.top, bounds_a)) { return true; }
+		/// @brief Default constructor (empty mask)
+		collision_mask() : m_width(0), m_height(0), m_nb_word(0), m_bits() { }
 		
-		if (is_in_rectangle(bounds_b.left, bounds_b.top + bounds_b.height, bounds_a)) { return true; }
+		/// @brief Constructor from an image
+		/// @param[in] image           Image (image(x, y), like thoth::texture::image())
+		/// @param[in] alpha_threshold A pixel is opaque if its alpha is greater than alpha_threshold (0 by default)
+		explicit collision_mask(hnc::vector2D<hnc::color> const & image, hnc::uint8 const alpha_threshold = 0) :
+			m_width(image.nb_row()),
+			m_height(image.nb_col()),
+			m_nb_word((m_width + 63) / 64),
+			m_bits(m_nb_word * m_height, 0)
+		{
+			for (std::size_t x = 0; x < m_width; ++x)
+			{
+				for (std::size_t y = 0; y < m_height; ++y)
+				{
+					if (image(x, y).a > alpha_threshold) { m_bits[y * m_nb_word + x / 64] |= std::uint64_t(1) << (x % 64); }
+				}
+			}
+		}
 		
-		if (is_in_rectangle(bounds_b.left + bounds_b.width, bounds_b.top + bounds_b.height, bounds_a)) { return true; }
+		/// @brief Return the width
+		/// @return the width (in pixels)
+		std::size_t width() const { return m_width; }
 		
-		// In bounds_b
+		/// @brief Return the height
+		/// @return the height (in pixels)
+		std::size_t height() const { return m_height; }
 		
-		if (is_in_rectangle(bounds_a.left, bounds_a.top, bounds_b)) { return true; }
+		/// @brief Test a pixel
+		/// @param[in] x Coordinate x
+		/// @param[in] y Coordinate y
+		/// @return true if the pixel is in the mask and opaque, false otherwise
+		bool is_opaque(long int const x, long int const y) const
+		{
+			if (x < 0 || y < 0 || std::size_t(x) >= m_width || std::size_t(y) >= m_height) { return false; }
+			return (m_bits[std::size_t(y) * m_nb_word + std::size_t(x) / 64] >> (std::size_t(x) % 64)) & 1;
+		}
 		
-		if (is_in_rectangle(bounds_a.left + bounds_a.width, bounds_a.top, bounds_b)) { return true; }
+		/// @brief Return 64 pixels of a row (the pixels outside the mask are transparent)
+		/// @param[in] y Row
+		/// @param[in] x First pixel (bit 0 of the result)
+		/// @return the 64 pixels from x
+		std::uint64_t bits(std::size_t const y, std::size_t const x) const
+		{
+			std::size_t const word = x / 64;
+			std::size_t const shift = x % 64;
+			std::uint64_t const * const row = m_bits.data() + y * m_nb_word;
+			std::uint64_t r = (word < m_nb_word) ? (row[word] >> shift) : 0;
+			if (shift != 0 && word + 1 < m_nb_word) { r |= row[word + 1] << (64 - shift); }
+			return r;
+		}
 		
-		if (is_in_rectangle(bounds_a.left, bounds_a.top + bounds_a.height, bounds_b)) { return true; }
+		/**
+		 * @brief Test if two masks have an opaque pixel at the same place
+		 * 
+		 * @param[in] mask_b Other mask
+		 * @param[in] rect_a Part of this mask used
+		 * @param[in] rect_b Part of mask_b used
+		 * @param[in] dx     Position x of the part of mask_b in the part of this mask
+		 * @param[in] dy     Position y of the part of mask_b in the part of this mask
+		 * 
+		 * @return true if an opaque pixel of the part of mask_b is on an opaque pixel of the part of this mask
+		 */
+		bool overlaps
+		(
+			collision_mask const & mask_b,
+			hnc::geometry::rectangle<long int> rect_a, hnc::geometry::rectangle<long int> rect_b,
+			long int const dx, long int const dy
+		) const
+		{
+			// Keep the parts in the masks (and the position of the part of mask_b)
+			long int const a_left = rect_a.left;
+			long int const a_top = rect_a.top;
+			long int const b_left = rect_b.left;
+			long int const b_top = rect_b.top;
+			clip(rect_a);
+			mask_b.clip(rect_b);
+			long int const dx_clip = dx + (rect_b.left - b_left) - (rect_a.left - a_left);
+			long int const dy_clip = dy + (rect_b.top - b_top) - (rect_a.top - a_top);
+			
+			// Overlap in the coordinates of the part of this mask
+			long int const x_begin = std::max(0l, dx_clip);
+			long int const y_begin = std::max(0l, dy_clip);
+			long int const x_end = std::min(rect_a.width, dx_clip + rect_b.width);
+			long int const y_end = std::min(rect_a.height, dy_clip + rect_b.height);
+			
+			for (long int y = y_begin; y < y_end; ++y)
+			{
+				std::size_t const row_a = std::size_t(rect_a.top + y);
+				std::size_t const row_b = std::size_t(rect_b.top + y - dy_clip);
+				for (long int x = x_begin; x < x_end; x += 64)
+				{
+					std::uint64_t const a = bits(row_a, std::size_t(rect_a.left + x));
+					std::uint64_t const b = mask_b.bits(row_b, std::size_t(rect_b.left + x - dx_clip));
+					long int const n = std::min(64l, x_end - x);
+					std::uint64_t const keep = (n == 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1);
+					if ((a & b & keep) != 0) { return true; }
+				}
+			}
+			
+			return false;
+		}
 		
-		if (is_in_rectangle(bounds_a.left + bounds_a.width, bounds_a.top + bounds_a.height, bounds_b)) { return true; }
+	private:
 		
-		return false;
+		/// @brief Clip a rectangle to the mask
+		/// @param[in,out] rect Rectangle
+		void clip(hnc::geometry::rectangle<long int> & rect) const
+		{
+			long int const left = std::max(0l, rect.left);
+			long int const top = std::max(0l, rect.top);
+			long int const right = std::min(long(m_width), rect.left + rect.width);
+			long int const bottom = std::min(long(m_height), rect.top + rect.height);
+			rect = { left, top, std::max(0l, right - left), std::max(0l, bottom - top) };
+		}
+	};
+	
+	/**
+	 * @brief Collision masks of the textures, by texture key
+	 * 
+	 * @code
+	   #include <thoth/collision.hpp>
+	   @endcode
+	 * 
+	 * Call thoth::collision_masks().erase(key) after reloading a texture.
+	 * 
+	 * @return the collision masks
+	 */
+	inline std::unordered_map<std::string, thoth::collision_mask> & collision_masks()
+	{
+		static std::unordered_map<std::string, thoth::collision_mask> collision_masks;
+		return collision_masks;
+	}
+	
+	/**
+	 * @brief Return the collision mask of a texture (computed from thoth::texture::image() the first time)
+	 * 
+	 * @code
+	   #include <thoth/collision.hpp>
+	   @endcode
+	 * 
+	 * @param[in] texture A thoth::texture
+	 * 
+	 * @return the collision mask of the texture
+	 */
+	inline thoth::collision_mask const & collision_mask_of(thoth::texture const & texture)
+	{
+		auto it = thoth::collision_masks().find(texture.key());
+		if (it == thoth::collision_masks().end())
+		{
+			it = thoth::collision_masks().emplace(texture.key(), thoth::collision_mask(texture.image())).first;
+		}
+		return it->second;
 	}
 	
 	/**
 	 * @brief Pixel perfect collision
 	 * 
 	 * Detect collision only on no-transparent parts of the sprite. @n
+	 * When the sprites are not rotated nor scaled, the rows of the masks are compared 64 pixels at a time;
+	 * otherwise each pixel of the intersection of the bounds is transformed in both sprites.
 	 * 
 	 * @note If you do not care about transparency of the sprite, please use thoth::collision function.
 	 * @code
@@ -94,13 +288,194 @@ namespace thoth
 		{
 			return false;
 		}
+		
 		// Possible collision
-		else
+		thoth::collision_mask const & mask_a = thoth::collision_mask_of(sprite_a.texture());
+		thoth::collision_mask const & mask_b = thoth::collision_mask_of(sprite_b.texture());
+		sf::Sprite const & sfml_a = sprite_a.sfml_sprite();
+		sf::Sprite const & sfml_b = sprite_b.sfml_sprite();
+		sf::IntRect const texture_rect_a = sfml_a.getTextureRect();
+		sf::IntRect const texture_rect_b = sfml_b.getTextureRect();
+		
+		float const * const matrix_a = sfml_a.getTransform().getMatrix();
+		float const * const matrix_b = sfml_b.getTransform().getMatrix();
+		auto const is_translation = [](float const * const m) -> bool
 		{
-			// TODO
-			return false;
+			return m[0] == 1.f && m[5] == 1.f && m[1] == 0.f && m[4] == 0.f;
+		};
+		
+		// Translation only: compare the masks by blocks of 64 pixels
+		if
+		(
+			is_translation(matrix_a) && is_translation(matrix_b) &&
+			texture_rect_a.width > 0 && texture_rect_a.height > 0 && texture_rect_b.width > 0 && texture_rect_b.height > 0
+		)
+		{
+			return mask_a.overlaps
+			(
+				mask_b,
+				{ texture_rect_a.left, texture_rect_a.top, texture_rect_a.width, texture_rect_a.height },
+				{ texture_rect_b.left, texture_rect_b.top, texture_rect_b.width, texture_rect_b.height },
+				long(std::lround(matrix_b[12] - matrix_a[12])),
+				long(std::lround(matrix_b[13] - matrix_a[13]))
+			);
+		}
+		
+		// Other transformations: test each pixel of the intersection of the bounds
+		auto const bounds_a = sprite_a.bounds_global();
+		auto const bounds_b = sprite_b.bounds_global();
+		float const left = std::max(bounds_a.left, bounds_b.left);
+		float const top = std::max(bounds_a.top, bounds_b.top);
+		float const right = std::min(bounds_a.left + bounds_a.width, bounds_b.left + bounds_b.width);
+		float const bottom = std::min(bounds_a.top + bounds_a.height, bounds_b.top + bounds_b.height);
+		sf::Transform const & inverse_a = sfml_a.getInverseTransform();
+		sf::Transform const & inverse_b = sfml_b.getInverseTransform();
+		auto const is_opaque = [](thoth::collision_mask const & mask, sf::IntRect const & texture_rect, sf::Vector2f const & p) -> bool
+		{
+			if (p.x < 0.f || p.y < 0.f || p.x >= float(std::abs(texture_rect.width)) || p.y >= float(std::abs(texture_rect.height))) { return false; }
+			long int const x = (texture_rect.width > 0) ? texture_rect.left + long(p.x) : texture_rect.left - 1 - long(p.x);
+			long int const y = (texture_rect.height > 0) ? texture_rect.top + long(p.y) : texture_rect.top - 1 - long(p.y);
+			return mask.is_opaque(x, y);
+		};
+		for (float y = std::floor(top) + 0.5f; y < bottom; y += 1.f)
+		{
+			for (float x = std::floor(left) + 0.5f; x < right; x += 1.f)
+			{
+				if
+				(
+					is_opaque(mask_a, texture_rect_a, inverse_a.transformPoint(x, y)) &&
+					is_opaque(mask_b, texture_rect_b, inverse_b.transformPoint(x, y))
+				)
+				{
+					return true;
+				}
+			}
 		}
+		return false;
 	}
+	
+	/**
+	 * @brief Broad phase of collision detection: sweep and prune on the bounds
+	 * 
+	 * @code
+	   #include <thoth/collision.hpp>
+	   @endcode
+	 * 
+	 * The bounds are sorted by left side, then swept while keeping the bounds which still cover the current left side. @n
+	 * The order is kept between two updates and sorted by insertion, which is almost linear when objects move a little each frame. @n
+	 * The pairs returned overlap (thoth::collision on the bounds), call thoth::collision_pixel_perfect on them if needed.
+	 * 
+	 * @code
+	   thoth::sweep_and_prune broad_phase;
+	   // Each frame
+	   for (auto const & pair : broad_phase.update(obstacles))
+	   {
+	   	if (thoth::collision_pixel_perfect(obstacles[pair.first], obstacles[pair.second])) { ... }
+	   }
+	   @endcode
+	 */
+	class sweep_and_prune
+	{
+	public:
+		
+		/// Pair of indexes (first < second)
+		using pair_t = std::pair<std::size_t, std::size_t>;
+		
+	private:
+		
+		/// Bounds
+		std::vector<hnc::geometry::rectangle<float>> m_bounds;
+		
+		/// Indexes sorted by left side
+		std::vector<std::size_t> m_order;
+		
+		/// Indexes whose bounds cover the current left side
+		std::vector<std::size_t> m_active;
+		
+		/// Pairs of overlapping bounds
+		std::vector<pair_t> m_pairs;
+		
+	public:
+		
+		/// @brief Find the pairs of objects whose bounds overlap
+		/// @param[in] objects Objects with a bounds_global() function (thoth::sprite, ...)
+		/// @return the pairs of indexes of overlapping objects
+		template <class container_t>
+		std::vector<pair_t> const & update(container_t const & objects)
+		{
+			m_bounds.clear();
+			for (auto const & object : objects) { m_bounds.push_back(object.bounds_global()); }
+			return sweep();
+		}
+		
+		/// @brief Find the pairs of overlapping rectangles
+		/// @param[in] bounds Rectangles
+		/// @return the pairs of indexes of overlapping rectangles
+		std::vector<pair_t> const & update(std::vector<hnc::geometry::rectangle<float>> const & bounds)
+		{
+			m_bounds = bounds;
+			return sweep();
+		}
+		
+		/// @brief Return the pairs found by the last update
+		/// @return the pairs of indexes of overlapping objects
+		std::vector<pair_t> const & pairs() const { return m_pairs; }
+		
+	private:
+		
+		/// @brief Sort and sweep m_bounds
+		/// @return the pairs of indexes of overlapping bounds
+		std::vector<pair_t> const & sweep()
+		{
+			// Keep the previous order if the number of objects is the same
+			if (m_order.size() != m_bounds.size())
+			{
+				m_order.resize(m_bounds.size());
+				for (std::size_t i = 0; i < m_order.size(); ++i) { m_order[i] = i; }
+				std::sort(m_order.begin(), m_order.end(), [&](std::size_t const a, std::size_t const b) { return m_bounds[a].left < m_bounds[b].left; });
+			}
+			else
+			{
+				// Insertion sort (objects move a little between two frames)
+				for (std::size_t i = 1; i < m_order.size(); ++i)
+				{
+					std::size_t const index = m_order[i];
+					float const left = m_bounds[index].left;
+					std::size_t j = i;
+					for (; j > 0 && m_bounds[m_order[j - 1]].left > left; --j) { m_order[j] = m_order[j - 1]; }
+					m_order[j] = index;
+				}
+			}
+			
+			// Sweep
+			m_pairs.clear();
+			m_active.clear();
+			for (std::size_t const index : m_order)
+			{
+				auto const & bounds = m_bounds[index];
+				
+				// Remove the bounds which end before this one
+				m_active.erase
+				(
+					std::remove_if
+					(
+						m_active.begin(), m_active.end(),
+						[&](std::size_t const active) { return m_bounds[active].left + m_bounds[active].width < bounds.left; }
+					),
+					m_active.end()
+				);
+				
+				for (std::size_t const active : m_active)
+				{
+					if (thoth::collision(m_bounds[active], bounds)) { m_pairs.emplace_back(std::min(active, index), std::max(active, index)); }
+				}
+				
+				m_active.push_back(index);
+			}
+			
+			return m_pairs;
+		}
+	};
 }
 
 #endif
@@ -20,12 +20,17 @@
 #define THOTH_ISOMETRIC_MAP_HPP
 
 #include <vector>
-#include <unordered_map>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 
-#include <hnc/optional.hpp>
+#include <hnc/vector2D.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/View.hpp>
 
 #include "sprite_centered.hpp"
+#include "sprite_batch.hpp"
 
 
 namespace thoth
@@ -36,11 +41,27 @@ namespace thoth
 	 * @code
 	   #include <thoth/isometric_map.hpp>
 	   @endcode
+	 * 
+	 * The tiles are stored line by line (the drawing order). @n
+	 * The tile of a position is computed from the line and the column (no search). @n
+	 * The map is cut in chunks (chunk_size lines x chunk_size tiles), only the chunks which intersect the view are drawn.
 	 */
 	class isometric_map
 	{
 	private:
 		
+		/// Bounds of a chunk
+		class chunk_t
+		{
+		public:
+			
+			/// Union of the global bounds of the tiles
+			sf::FloatRect bounds;
+			
+			/// true if the chunk has no tile
+			bool is_empty = true;
+		};
+		
 		/// Tile width
 		std::size_t m_tile_width;
 		
@@ -56,8 +77,17 @@ namespace thoth
 		/// Number of lines
 		std::size_t m_nb_line;
 		
-		/// Tiles per size
-		std::unordered_map<std::intmax_t, std::unordered_map<std::intmax_t, std::size_t>> m_sizes_i_tiles;
+		/// Index of the first tile of each line (and the number of tiles at the end)
+		std::vector<std::size_t> m_line_first;
+		
+		/// Number of lines (and of half tile widths) in a chunk
+		std::size_t m_chunk_size;
+		
+		/// Chunks
+		hnc::vector2D<chunk_t> m_chunks;
+		
+		/// Sprite batch of the draw (keeps its memory between frames)
+		mutable thoth::sprite_batch m_batch;
 		
 	public:
 		
@@ -67,32 +97,41 @@ namespace thoth
 	public:
 		
 		/// @brief Default constructor
-		isometric_map() = default;
+		isometric_map() :
+			m_tile_width(0), m_tile_height(0), m_tile_width_half(0), m_tile_height_half(0),
+			m_nb_line(0), m_line_first(1, 0), m_chunk_size(1), m_chunks(), m_batch(), tiles()
+		{ }
 		
 		/// @brief Constructor
 		/// @param[in] default_texture Default texture for all tile
 		/// @param[in] tile_width      Width of a tile (example: 222)
 		/// @param[in] tile_height     Height of a tile (example: 128)
 		/// @param[in] nb_line         Approximate number of lines wanted
+		/// @param[in] chunk_size      Number of lines of a chunk (16 by default)
 		isometric_map
 		(
 			thoth::texture const & default_texture,
 			std::size_t const tile_width,
 			std::size_t const tile_height,
-			std::size_t const nb_line
+			std::size_t const nb_line,
+			std::size_t const chunk_size = 16
 		) :
 			m_tile_width(tile_width),
 			m_tile_height(tile_height),
 			m_tile_width_half(tile_width / 2),
 			m_tile_height_half(tile_height / 2),
-			m_nb_line(nb_line + nb_line % 2)
+			m_nb_line(nb_line + nb_line % 2),
+			m_line_first(m_nb_line + 1, 0),
+			m_chunk_size(std::max(chunk_size, std::size_t(1))),
+			m_chunks((m_nb_line + m_chunk_size - 1) / m_chunk_size, (m_nb_line + 2) / (2 * m_chunk_size) + 1),
+			m_batch()
 		{
 			// Tiles
 			for (std::size_t line = 0; line < m_nb_line; ++line)
 			{
-				std::size_t nb_column = std::min(line, m_nb_line - line);
+				m_line_first[line] = tiles.size();
 				
-				for (std::size_t column = 0; column < nb_column; ++column)
+				for (std::size_t column = 0; column < nb_column(line); ++column)
 				{
 					tiles.emplace_back
 					(
@@ -100,21 +139,16 @@ namespace thoth
 						default_texture,
 						// x
 						float(column * tile_width)
-						+ float(((m_nb_line / 2) - nb_column + 1) * tile_width_half()),
+						+ float(first_half_width(line) * tile_width_half()),
 						// y
 						float(line * tile_height_half())
 					);
-					
-					//std::cout << tiles.back().position() << std::endl;
 				}
 			}
+			m_line_first[m_nb_line] = tiles.size();
 			tiles.shrink_to_fit();
 			
-			// Tiles per size
-			for (std::size_t i = 0; i < tiles.size(); ++i)
-			{
-				m_sizes_i_tiles[std::intmax_t(tiles[i].position().x)][std::intmax_t(tiles[i].position().y)] = i;
-			}
+			update_bounds();
 		}
 		
 		/// @brief Get tile width
@@ -133,13 +167,22 @@ namespace thoth
 		/// @return half of tile height
 		std::size_t tile_height_half() const { return m_tile_height_half; }
 		
+		/// @brief Get the number of lines
+		/// @return the number of lines
+		std::size_t nb_line() const { return m_nb_line; }
+		
+		/// @brief Get the number of tiles of a line
+		/// @param[in] line Line
+		/// @return the number of tiles of the line
+		std::size_t nb_column(std::size_t const line) const { return std::min(line, m_nb_line - line); }
+		
 		/// @brief Get iterator on closer sprite
 		/// @param[in] position Position in view
 		/// @return iterator on closer sprite
 		template <class vector2_t>
 		std::vector<thoth::sprite_centered>::iterator get_sprite_it(vector2_t const & position)
 		{
-			// TODO Optimize with math
+			if (m_tile_width_half == 0 || m_tile_height_half == 0) { return tiles.end(); }
 			
 			using x_y_t = decltype(position.x);
 			
@@ -149,24 +192,19 @@ namespace thoth
 			auto x_trunc = std::intmax_t(std::trunc(position.x / x_y_t(m_tile_width_half)) * m_tile_width_half);
 			auto y_trunc = std::intmax_t(std::trunc(position.y / x_y_t(m_tile_height_half)) * m_tile_height_half);
 			
+			// Tile centered on (x, y)
 			auto is_selectioned_tile = [&](std::intmax_t const x, std::intmax_t const y) -> std::vector<thoth::sprite_centered>::iterator
 			{
-				std::vector<thoth::sprite_centered>::iterator it = tiles.end();
+				if (y < 0 || y % std::intmax_t(m_tile_height_half) != 0) { return tiles.end(); }
+				std::size_t const line = std::size_t(y) / m_tile_height_half;
+				if (line >= m_nb_line) { return tiles.end(); }
 				
-				// Tile exists
-				if (m_sizes_i_tiles.find(x) != m_sizes_i_tiles.end())
-				{
-					if (m_sizes_i_tiles.at(x).find(y) != m_sizes_i_tiles.at(x).end())
-					{
-						// Collision
-						if (true) // TODO
-						{
-							it = tiles.begin() + std::ptrdiff_t(m_sizes_i_tiles.at(x).at(y));
-						}
-					}
-				}
+				std::intmax_t const x_first = std::intmax_t(first_half_width(line) * m_tile_width_half);
+				if (x < x_first || (x - x_first) % std::intmax_t(m_tile_width) != 0) { return tiles.end(); }
+				std::size_t const column = std::size_t(x - x_first) / m_tile_width;
+				if (column >= nb_column(line)) { return tiles.end(); }
 				
-				return it;
+				return tiles.begin() + std::ptrdiff_t(m_line_first[line] + column);
 			};
 			
 			// x_round, y_round
@@ -195,19 +233,133 @@ namespace thoth
 			
 			return tiles.end();
 		}
+		
+		/// @brief Compute the bounds of the chunks
+		/// @note Call it after changing the textures or the positions of the tiles
+		void update_bounds()
+		{
+			for (auto chunks_line : m_chunks)
+			{
+				for (chunk_t & chunk : chunks_line) { chunk = chunk_t(); }
+			}
+			
+			for (std::size_t line = 0; line < m_nb_line; ++line)
+			{
+				for (std::size_t column = 0; column < nb_column(line); ++column)
+				{
+					chunk_t & chunk = m_chunks(line / m_chunk_size, (first_half_width(line) + 2 * column) / (2 * m_chunk_size));
+					sf::FloatRect const tile_bounds = tiles[m_line_first[line] + column].sfml_sprite().getGlobalBounds();
+					
+					if (chunk.is_empty)
+					{
+						chunk.bounds = tile_bounds;
+						chunk.is_empty = false;
+					}
+					else
+					{
+						float const left = std::min(chunk.bounds.left, tile_bounds.left);
+						float const top = std::min(chunk.bounds.top, tile_bounds.top);
+						float const right = std::max(chunk.bounds.left + chunk.bounds.width, tile_bounds.left + tile_bounds.width);
+						float const bottom = std::max(chunk.bounds.top + chunk.bounds.height, tile_bounds.top + tile_bounds.height);
+						chunk.bounds = sf::FloatRect(left, top, right - left, bottom - top);
+					}
+				}
+			}
+		}
+		
+		/**
+		 * @brief Call a function on the tiles of the chunks which intersect an area, in the drawing order
+		 * @param[in] area Area (in the coordinates of the map)
+		 * @param[in] f    Function called with a thoth::sprite_centered const &
+		 */
+		template <class function_t>
+		void for_each_visible_tile(sf::FloatRect const & area, function_t f) const
+		{
+			std::vector<std::size_t> visible_chunks;
+			visible_chunks.reserve(m_chunks.nb_col());
+			
+			for (std::size_t chunk_line = 0; chunk_line < m_chunks.nb_row(); ++chunk_line)
+			{
+				// Visible chunks of the band
+				visible_chunks.clear();
+				for (std::size_t chunk_column = 0; chunk_column < m_chunks.nb_col(); ++chunk_column)
+				{
+					chunk_t const & chunk = m_chunks(chunk_line, chunk_column);
+					if (chunk.is_empty == false && chunk.bounds.intersects(area)) { visible_chunks.push_back(chunk_column); }
+				}
+				if (visible_chunks.empty()) { continue; }
+				
+				// Line by line (the tiles of a line in a chunk are contiguous)
+				std::size_t const line_end = std::min((chunk_line + 1) * m_chunk_size, m_nb_line);
+				for (std::size_t line = chunk_line * m_chunk_size; line < line_end; ++line)
+				{
+					for (std::size_t const chunk_column : visible_chunks)
+					{
+						std::size_t const column_begin = first_column(line, chunk_column * 2 * m_chunk_size);
+						std::size_t const column_end = first_column(line, (chunk_column + 1) * 2 * m_chunk_size);
+						for (std::size_t column = column_begin; column < column_end; ++column)
+						{
+							f(tiles[m_line_first[line] + column]);
+						}
+					}
+				}
+			}
+		}
+		
+		/// @brief Return the area seen by a view
+		/// @param[in] view A SFML view
+		/// @return the bounding rectangle of the area seen by the view
+		static sf::FloatRect view_area(sf::View const & view)
+		{
+			return view.getInverseTransform().transformRect(sf::FloatRect(-1.f, -1.f, 2.f, 2.f));
+		}
+		
+		/// @brief Draw the map
+		/// @param[in,out] target Render target
+		/// @note Only the chunks in the view are drawn, with the thoth::sprite_batch of the map
+		/// (one draw call per run of tiles on the same atlas page after thoth::textures().build_atlas()). @n
+		/// The batch is a member of the map: a map is drawn by one thread at a time
+		void draw(sf::RenderTarget & target) const
+		{
+			m_batch.clear();
+			for_each_visible_tile
+			(
+				thoth::isometric_map::view_area(target.getView()),
+				[this](thoth::sprite_centered const & tile) { m_batch.add(tile); }
+			);
+			m_batch.draw(target);
+		}
+		
+	private:
+		
+		/// @brief Return the position of the first tile of a line, in half tile widths
+		/// @param[in] line Line
+		/// @return the position of the first tile of the line, in half tile widths
+		std::size_t first_half_width(std::size_t const line) const
+		{
+			return (m_nb_line / 2) - nb_column(line) + 1;
+		}
+		
+		/// @brief Return the first column of a line at or after a position
+		/// @param[in] line       Line
+		/// @param[in] half_width Position, in half tile widths
+		/// @return the first column at or after the position (nb_column(line) if there is none)
+		std::size_t first_column(std::size_t const line, std::size_t const half_width) const
+		{
+			std::size_t const first = first_half_width(line);
+			if (half_width <= first) { return 0; }
+			return std::min((half_width - first + 1) / 2, nb_column(line));
+		}
 	};
 	
 	/// @brief Operator << between a sf::RenderWindow and a thoth::isometric_map
 	/// @param[in,out] window        A sf::RenderWindow
 	/// @param[in]     isometric_map A thoth::isometric_map
 	/// @return the output stream
+	/// @note See thoth::isometric_map::draw
 	inline sf::RenderWindow & operator <<(sf::RenderWindow & window, thoth::isometric_map const & isometric_map)
 	{
-		for (auto const & tile : isometric_map.tiles)
-		{
-			window << tile;
-		}
-		
+		isometric_map.draw(window);
 		return window;
 	}
 }
@@ -0,0 +1,206 @@
+// Copyright © 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of Thōth.
+
+// Thōth is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Thōth is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with Thōth. If not, see <http://www.gnu.org/licenses/>
+
+
+#ifndef THOTH_PACKET_LAYOUT_HPP
+#define THOTH_PACKET_LAYOUT_HPP
+
+#include <cstring>
+
+#include <SFML/Config.hpp>
+
+
+namespace thoth
+{
+	/**
+	 * @brief Size and encoding of a fixed-size field of a sf::Packet
+	 * 
+	 * @code
+	   #include <thoth/packet_layout.hpp>
+	   @endcode
+	 * 
+	 * The encoding is the same as the sf::Packet operator << (integers in big endian, float and double as is),
+	 * so a packet written with thoth::packet_layout is read with a sf::Packet and the operator >>.
+	 * 
+	 * Only bool, sf::Int8, sf::Uint8, sf::Int16, sf::Uint16, sf::Int32, sf::Uint32, sf::Int64, sf::Uint64,
+	 * float and double are fixed-size fields (the other types do not compile).
+	 */
+	template <class T>
+	class packet_field;
+	
+	/// @brief Write an integer in big endian
+	/// @param[out] out   Output bytes
+	/// @param[in]  value Integer
+	template <class T>
+	void packet_write_big_endian(char * out, T const value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			out[i] = char(static_cast<unsigned char>(value >> (8 * (sizeof(T) - 1 - i))));
+		}
+	}
+	
+	/// @brief Read an integer in big endian
+	/// @param[in] in Input bytes
+	/// @return the integer
+	template <class T>
+	T packet_read_big_endian(char const * in)
+	{
+		T value = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			value = T((value << 8) | T(static_cast<unsigned char>(in[i])));
+		}
+		return value;
+	}
+	
+	/// @brief Fixed-size integer field (big endian)
+	template <class T, class unsigned_t>
+	class packet_field_integer
+	{
+	public:
+		
+		/// Size in the packet
+		static std::size_t const size = sizeof(T);
+		
+		/// @brief Write the field
+		/// @param[out] out   Output bytes
+		/// @param[in]  value Value
+		static void write(char * out, T const value) { packet_write_big_endian(out, unsigned_t(value)); }
+		
+		/// @brief Read the field
+		/// @param[in]  in    Input bytes
+		/// @param[out] value Value
+		static void read(char const * in, T & value) { value = T(packet_read_big_endian<unsigned_t>(in)); }
+	};
+	
+	/// @brief Fixed-size field copied as is (float and double)
+	template <class T>
+	class packet_field_raw
+	{
+	public:
+		
+		/// Size in the packet
+		static std::size_t const size = sizeof(T);
+		
+		/// @brief Write the field
+		/// @param[out] out   Output bytes
+		/// @param[in]  value Value
+		static void write(char * out, T const value) { std::memcpy(out, &value, sizeof(T)); }
+		
+		/// @brief Read the field
+		/// @param[in]  in    Input bytes
+		/// @param[out] value Value
+		static void read(char const * in, T & value) { std::memcpy(&value, in, sizeof(T)); }
+	};
+	
+	/// @brief bool field (one byte)
+	template <>
+	class packet_field<bool>
+	{
+	public:
+		
+		/// Size in the packet
+		static std::size_t const size = 1;
+		
+		/// @brief Write the field
+		/// @param[out] out   Output bytes
+		/// @param[in]  value Value
+		static void write(char * out, bool const value) { out[0] = char(value ? 1 : 0); }
+		
+		/// @brief Read the field
+		/// @param[in]  in    Input bytes
+		/// @param[out] value Value
+		static void read(char const * in, bool & value) { value = (in[0] != 0); }
+	};
+	
+	template <> class packet_field<sf::Int8> : public thoth::packet_field_integer<sf::Int8, sf::Uint8> { };
+	template <> class packet_field<sf::Uint8> : public thoth::packet_field_integer<sf::Uint8, sf::Uint8> { };
+	template <> class packet_field<sf::Int16> : public thoth::packet_field_integer<sf::Int16, sf::Uint16> { };
+	template <> class packet_field<sf::Uint16> : public thoth::packet_field_integer<sf::Uint16, sf::Uint16> { };
+	template <> class packet_field<sf::Int32> : public thoth::packet_field_integer<sf::Int32, sf::Uint32> { };
+	template <> class packet_field<sf::Uint32> : public thoth::packet_field_integer<sf::Uint32, sf::Uint32> { };
+	template <> class packet_field<sf::Int64> : public thoth::packet_field_integer<sf::Int64, sf::Uint64> { };
+	template <> class packet_field<sf::Uint64> : public thoth::packet_field_integer<sf::Uint64, sf::Uint64> { };
+	template <> class packet_field<float> : public thoth::packet_field_raw<float> { };
+	template <> class packet_field<double> : public thoth::packet_field_raw<double> { };
+	
+	/**
+	 * @brief Compile-time layout of a pack of fixed-size fields
+	 * 
+	 * @code
+	   #include <thoth/packet_layout.hpp>
+	   @endcode
+	 * 
+	 * @code
+	   using layout = thoth::packet_layout<sf::Uint32, float, float>;
+	   char buffer[layout::size]; // 12 bytes, known at compile time
+	   layout::write(buffer, id, x, y);
+	   layout::read(buffer, id, x, y);
+	   @endcode
+	 */
+	template <class ... args_t>
+	class packet_layout;
+	
+	/// @brief Layout of an empty pack
+	template <>
+	class packet_layout<>
+	{
+	public:
+		
+		/// Size of the fields
+		static std::size_t const size = 0;
+		
+		/// @brief Write nothing
+		static void write(char *) { }
+		
+		/// @brief Read nothing
+		static void read(char const *) { }
+	};
+	
+	/// @brief Layout of a pack of fields
+	template <class T, class ... args_t>
+	class packet_layout<T, args_t...>
+	{
+	public:
+		
+		/// Size of the fields
+		static std::size_t const size = thoth::packet_field<T>::size + thoth::packet_layout<args_t...>::size;
+		
+		/// @brief Write the fields
+		/// @param[out] out  Output bytes (size bytes)
+		/// @param[in]  t    First field
+		/// @param[in]  args Other fields
+		static void write(char * out, T const & t, args_t const & ... args)
+		{
+			thoth::packet_field<T>::write(out, t);
+			thoth::packet_layout<args_t...>::write(out + thoth::packet_field<T>::size, args...);
+		}
+		
+		/// @brief Read the fields
+		/// @param[in]  in   Input bytes (size bytes)
+		/// @param[out] t    First field
+		/// @param[out] args Other fields
+		static void read(char const * in, T & t, args_t & ... args)
+		{
+			thoth::packet_field<T>::read(in, t);
+			thoth::packet_layout<args_t...>::read(in + thoth::packet_field<T>::size, args...);
+		}
+	};
+}
+
+#endif
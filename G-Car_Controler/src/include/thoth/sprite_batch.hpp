@@ -0,0 +1,198 @@
+// Copyright © 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of Thōth.
+
+// Thōth is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Thōth is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with Thōth. If not, see <http://www.gnu.org/licenses/>
+
+
+#ifndef THOTH_SPRITE_BATCH_HPP
+#define THOTH_SPRITE_BATCH_HPP
+
+#include <vector>
+#include <cmath>
+
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include "texture_atlas.hpp"
+#include "textures.hpp"
+#include "sprite.hpp"
+
+
+namespace thoth
+{
+	/**
+	 * @brief Sprite batch: draw many sprites with one draw call per run of sprites on the same atlas page
+	 * 
+	 * @code
+	   #include <thoth/sprite_batch.hpp>
+	   @endcode
+	 * 
+	 * Each frame, add the sprites then draw the batch. @n
+	 * The sprites are drawn in their order (painter's order). @n
+	 * The quads of the sprites whose texture is in the atlas (see thoth::textures_t::build_atlas) are
+	 * accumulated in one vertex buffer (it keeps its memory between frames), consecutive quads on the same page
+	 * are drawn with one draw call. @n
+	 * A sprite not in the atlas, or on another page, ends the run (the other sprites are drawn one by one).
+	 * 
+	 * @warning The sprites not in the atlas are kept by address, they must live until the draw
+	 * 
+	 * @code
+	   thoth::textures().build_atlas();
+	   thoth::sprite_batch batch;
+	   // Each frame
+	   batch.clear();
+	   for (auto const & sprite : sprites) { batch.add(sprite); }
+	   window << batch;
+	   @endcode
+	 */
+	class sprite_batch
+	{
+	private:
+		
+		/// Atlas
+		thoth::texture_atlas const * p_atlas;
+		
+		/**
+		 * @brief Consecutive quads on one page, or a sprite not in the atlas
+		 */
+		class run_t
+		{
+		public:
+			
+			/// Sprite not in the atlas (nullptr for quads)
+			sf::Sprite const * sprite;
+			
+			/// Page of the quads
+			std::size_t page;
+			
+			/// First vertex of the quads
+			std::size_t first_vertex;
+			
+			/// Number of vertices of the quads
+			std::size_t nb_vertex;
+		};
+		
+		/// Quads of the sprites in the atlas (in the order of the sprites)
+		std::vector<sf::Vertex> m_vertices;
+		
+		/// Runs (in the order of the sprites)
+		std::vector<run_t> m_runs;
+		
+	public:
+		
+		/// @brief Constructor
+		/// @param[in] atlas Atlas (thoth::textures().atlas() by default)
+		sprite_batch(thoth::texture_atlas const & atlas = thoth::textures().atlas()) :
+			p_atlas(&atlas),
+			m_vertices(),
+			m_runs()
+		{ }
+		
+		/// @brief Remove the sprites (the memory is kept)
+		void clear()
+		{
+			m_vertices.clear();
+			m_runs.clear();
+		}
+		
+		/// @brief Add a sprite
+		/// @param[in] sprite A thoth::sprite
+		void add(thoth::sprite const & sprite)
+		{
+			add(sprite.sfml_sprite(), sprite.texture());
+		}
+		
+		/// @brief Add a SFML sprite
+		/// @param[in] sprite  A SFML sprite
+		/// @param[in] texture Texture of the sprite
+		void add(sf::Sprite const & sprite, thoth::texture const & texture)
+		{
+			thoth::atlas_region const * const region = texture.region_in_atlas();
+			
+			// Not in the atlas
+			if (region == nullptr || region->page >= p_atlas->nb_page())
+			{
+				m_runs.push_back(run_t{ &sprite, 0, 0, 0 });
+				return;
+			}
+			
+			// New run if the previous sprite is not in the atlas or on another page
+			if (m_runs.empty() || m_runs.back().sprite != nullptr || m_runs.back().page != region->page)
+			{
+				m_runs.push_back(run_t{ nullptr, region->page, m_vertices.size(), 0 });
+			}
+			m_runs.back().nb_vertex += 4;
+			
+			// Local quad (like sf::Sprite)
+			sf::IntRect const rect = sprite.getTextureRect();
+			float const w = float(std::abs(rect.width));
+			float const h = float(std::abs(rect.height));
+			
+			// Texture coordinates in the page
+			float const left = float(region->rect.left + rect.left);
+			float const top = float(region->rect.top + rect.top);
+			float const right = left + float(rect.width);
+			float const bottom = top + float(rect.height);
+			
+			sf::Transform const & transform = sprite.getTransform();
+			sf::Color const color = sprite.getColor();
+			m_vertices.push_back(sf::Vertex(transform.transformPoint(0.f, 0.f), color, sf::Vector2f(left, top)));
+			m_vertices.push_back(sf::Vertex(transform.transformPoint(w, 0.f), color, sf::Vector2f(right, top)));
+			m_vertices.push_back(sf::Vertex(transform.transformPoint(w, h), color, sf::Vector2f(right, bottom)));
+			m_vertices.push_back(sf::Vertex(transform.transformPoint(0.f, h), color, sf::Vector2f(left, bottom)));
+		}
+		
+		/// @brief Return the number of draw calls of the next draw
+		/// @return the number of draw calls
+		std::size_t nb_draw_call() const
+		{
+			return m_runs.size();
+		}
+		
+		/// @brief Draw the sprites
+		/// @param[in,out] target Render target
+		/// @param[in]     states Render states (the texture is replaced by the page)
+		void draw(sf::RenderTarget & target, sf::RenderStates states = sf::RenderStates::Default) const
+		{
+			for (run_t const & run : m_runs)
+			{
+				if (run.sprite != nullptr)
+				{
+					states.texture = nullptr;
+					target.draw(*run.sprite, states);
+				}
+				else
+				{
+					states.texture = &p_atlas->page(run.page);
+					target.draw(m_vertices.data() + run.first_vertex, run.nb_vertex, sf::Quads, states);
+				}
+			}
+		}
+	};
+	
+	/// @brief Operator << between a sf::RenderWindow and a thoth::sprite_batch
+	/// @param[in,out] window       A sf::RenderWindow
+	/// @param[in]     sprite_batch A thoth::sprite_batch
+	/// @return the output stream
+	inline sf::RenderWindow & operator <<(sf::RenderWindow & window, thoth::sprite_batch const & sprite_batch)
+	{
+		sprite_batch.draw(window);
+		return window;
+	}
+}
+
+#endif
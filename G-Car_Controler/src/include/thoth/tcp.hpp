@@ -19,21 +19,36 @@
 #ifndef THOTH_TCP_HPP
 #define THOTH_TCP_HPP
 
+#include <atomic>
+#include <array>
 #include <memory>
 #include <functional>
 #include <thread>
+#include <vector>
+#include <cstring>
 
 #include <hnc/unused.hpp>
 
 #include <SFML/Network.hpp>
 
+#ifndef SFML_SYSTEM_WINDOWS
+	#include <cerrno>
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/uio.h>
+#else
+	#include <winsock2.h>
+#endif
+
 #include "serialization.hpp"
+#include "packet_layout.hpp"
 
 
 namespace thoth
 {
 	// Forward declaration
 	class tcp_listener;
+	class tcp_reactor;
 	
 	/// @brief Operator << between a std::ostream and a sf::Socket::Status
 	/// @param[in,out] o      Output stream
@@ -61,12 +76,272 @@ namespace thoth
 		return o;
 	}
 	
+	/**
+	 * @brief sf::TcpSocket with gather send, outgoing buffer and exact-size receive
+	 * 
+	 * @code
+	   #include <thoth/tcp.hpp>
+	   @endcode
+	 * 
+	 * sf::TcpSocket::send(sf::Packet &) allocates a std::vector for each packet to prepend the size;
+	 * send_gather sends the size and the data with one sendmsg (scatter/gather I/O) and without copy
+	 * (on Windows, the data are copied in a reused buffer and sent with one send). @n
+	 * On a non-blocking socket, send_gather never waits: the part of the packet which can not be sent now
+	 * is kept in the outgoing buffer (the stream stays framed) and flush sends it when the socket is writable again. @n
+	 * If the outgoing buffer would exceed max_pending_size (the peer does not read), the send fails with sf::Socket::Error.
+	 */
+	class tcp_socket : public sf::TcpSocket
+	{
+	public:
+		
+		/// Maximum size of the outgoing buffer in bytes (1 MiB by default)
+		std::size_t max_pending_size = std::size_t(1) << 20;
+		
+	private:
+		
+		#ifdef SFML_SYSTEM_WINDOWS
+			/// Reused buffer to concatenate the data
+			std::vector<char> m_gather_buffer;
+		#endif
+		
+		/// Outgoing buffer (data not sent yet)
+		std::vector<char> m_pending;
+		
+		/// First byte of m_pending not sent yet
+		std::size_t m_pending_first = 0;
+		
+		/// A send failed (disconnected, error or outgoing buffer full)
+		bool m_send_failed = false;
+		
+	public:
+		
+		/// @brief Default constructor
+		tcp_socket() = default;
+		
+		/// @brief Send two blocks of data as one
+		/// @param[in] a      First block
+		/// @param[in] a_size Size of the first block
+		/// @param[in] b      Second block
+		/// @param[in] b_size Size of the second block
+		/// @return the status of the socket (sf::Socket::Done if the data are sent or in the outgoing buffer)
+		sf::Socket::Status send_gather(void const * a, std::size_t a_size, void const * b, std::size_t b_size)
+		{
+			// The data already waiting are sent first (order of the stream)
+			sf::Socket::Status const r = flush();
+			if (r == sf::Socket::Disconnected || r == sf::Socket::Error) { return r; }
+			
+			#ifdef SFML_SYSTEM_WINDOWS
+				m_gather_buffer.resize(a_size + b_size);
+				if (a_size != 0) { std::memcpy(m_gather_buffer.data(), a, a_size); }
+				if (b_size != 0) { std::memcpy(m_gather_buffer.data() + a_size, b, b_size); }
+				a = m_gather_buffer.data();
+				a_size = m_gather_buffer.size();
+				b = nullptr;
+				b_size = 0;
+			#endif
+			
+			std::size_t const size = a_size + b_size;
+			std::size_t nb_sent_total = 0;
+			if (r == sf::Socket::Done)
+			{
+				while (nb_sent_total < size)
+				{
+					std::size_t nb_sent = 0;
+					auto const r_write = write_some(a, a_size, b, b_size, nb_sent_total, nb_sent);
+					if (r_write == sf::Socket::NotReady) { break; }
+					if (r_write != sf::Socket::Done) { return fail(r_write); }
+					nb_sent_total += nb_sent;
+				}
+			}
+			
+			// The rest waits in the outgoing buffer (non-blocking socket)
+			if (nb_sent_total < size)
+			{
+				if (pending_size() + (size - nb_sent_total) > max_pending_size) { return fail(sf::Socket::Error); }
+				
+				if (m_pending_first != 0)
+				{
+					m_pending.erase(m_pending.begin(), m_pending.begin() + std::ptrdiff_t(m_pending_first));
+					m_pending_first = 0;
+				}
+				if (nb_sent_total < a_size)
+				{
+					char const * const a_bytes = static_cast<char const *>(a);
+					m_pending.insert(m_pending.end(), a_bytes + nb_sent_total, a_bytes + a_size);
+				}
+				if (b_size != 0)
+				{
+					char const * const b_bytes = static_cast<char const *>(b);
+					std::size_t const b_first = (nb_sent_total > a_size) ? nb_sent_total - a_size : 0;
+					m_pending.insert(m_pending.end(), b_bytes + b_first, b_bytes + b_size);
+				}
+			}
+			
+			return sf::Socket::Done;
+		}
+		
+		/// @brief Send the outgoing buffer (without waiting on a non-blocking socket)
+		/// @return sf::Socket::Done if the outgoing buffer is empty, sf::Socket::NotReady if data are still waiting, the error otherwise
+		sf::Socket::Status flush()
+		{
+			while (m_pending_first < m_pending.size())
+			{
+				std::size_t nb_sent = 0;
+				auto const r = write_some(m_pending.data(), m_pending.size(), nullptr, 0, m_pending_first, nb_sent);
+				if (r == sf::Socket::NotReady) { return r; }
+				if (r != sf::Socket::Done) { return fail(r); }
+				m_pending_first += nb_sent;
+			}
+			
+			m_pending.clear();
+			m_pending_first = 0;
+			return sf::Socket::Done;
+		}
+		
+		/// @brief Return the number of bytes in the outgoing buffer
+		/// @return the number of bytes not sent yet
+		std::size_t pending_size() const { return m_pending.size() - m_pending_first; }
+		
+		/// @brief Return true if a send failed (disconnected, error or outgoing buffer full)
+		/// @return true if a send failed, false otherwise
+		bool send_failed() const { return m_send_failed; }
+		
+		/// @brief Disconnect (the outgoing buffer is cleared)
+		void disconnect()
+		{
+			m_pending.clear();
+			m_pending_first = 0;
+			m_send_failed = false;
+			sf::TcpSocket::disconnect();
+		}
+		
+		/// @brief Receive exactly size bytes
+		/// @param[out] data Received data
+		/// @param[in]  size Number of bytes to receive
+		/// @return the status of the socket
+		sf::Socket::Status receive_all(void * const data, std::size_t const size)
+		{
+			std::size_t nb_received_total = 0;
+			while (nb_received_total < size)
+			{
+				std::size_t nb_received = 0;
+				auto const r = receive(static_cast<char *>(data) + nb_received_total, size - nb_received_total, nb_received);
+				if (r != sf::Socket::Done) { return r; }
+				nb_received_total += nb_received;
+			}
+			return sf::Socket::Done;
+		}
+		
+		using sf::TcpSocket::send;
+		using sf::TcpSocket::receive;
+		
+	private:
+		
+		/// @brief Remember that a send failed
+		/// @param[in] r Status of the failed send
+		/// @return r
+		sf::Socket::Status fail(sf::Socket::Status const r)
+		{
+			m_send_failed = true;
+			return r;
+		}
+		
+		/// @brief Send the data of two blocks from an offset, with one system call
+		/// @param[in]  a       First block
+		/// @param[in]  a_size  Size of the first block
+		/// @param[in]  b       Second block (empty on Windows)
+		/// @param[in]  b_size  Size of the second block
+		/// @param[in]  offset  Number of bytes of the blocks already sent
+		/// @param[out] nb_sent Number of bytes sent
+		/// @return sf::Socket::Done if bytes are sent, sf::Socket::NotReady if the socket can not send now, the error otherwise
+		sf::Socket::Status write_some
+		(
+			void const * const a, std::size_t const a_size,
+			void const * const b, std::size_t const b_size,
+			std::size_t const offset, std::size_t & nb_sent
+		)
+		{
+			#ifdef SFML_SYSTEM_WINDOWS
+				hnc_unused(b);
+				hnc_unused(b_size);
+				
+				int const n = ::send(getHandle(), static_cast<char const *>(a) + offset, int(a_size - offset), 0);
+				if (n >= 0)
+				{
+					nb_sent = std::size_t(n);
+					return sf::Socket::Done;
+				}
+				
+				int const error = WSAGetLastError();
+				if (error == WSAEWOULDBLOCK || error == WSAEALREADY) { return sf::Socket::NotReady; }
+				if (error == WSAECONNABORTED || error == WSAECONNRESET || error == WSAETIMEDOUT || error == WSAENETRESET || error == WSAENOTCONN)
+				{
+					return sf::Socket::Disconnected;
+				}
+				return sf::Socket::Error;
+			#else
+				if (getHandle() < 0) { return sf::Socket::Error; }
+				
+				iovec blocks[2];
+				std::size_t nb_block = 0;
+				if (offset < a_size)
+				{
+					blocks[nb_block].iov_base = const_cast<char *>(static_cast<char const *>(a) + offset);
+					blocks[nb_block].iov_len = a_size - offset;
+					++nb_block;
+				}
+				if (b_size != 0)
+				{
+					std::size_t const b_first = (offset > a_size) ? offset - a_size : 0;
+					blocks[nb_block].iov_base = const_cast<char *>(static_cast<char const *>(b) + b_first);
+					blocks[nb_block].iov_len = b_size - b_first;
+					++nb_block;
+				}
+				
+				msghdr message;
+				std::memset(&message, 0, sizeof(message));
+				message.msg_iov = blocks;
+				message.msg_iovlen = nb_block;
+				
+				// Like SFML, no SIGPIPE if the connection is closed
+				#ifdef MSG_NOSIGNAL
+					int const flags = MSG_NOSIGNAL;
+				#else
+					int const flags = 0;
+				#endif
+				
+				while (true)
+				{
+					ssize_t const n = ::sendmsg(getHandle(), &message, flags);
+					if (n >= 0)
+					{
+						nb_sent = std::size_t(n);
+						return sf::Socket::Done;
+					}
+					
+					if (errno == EINTR) { continue; }
+					if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS) { return sf::Socket::NotReady; }
+					if (errno == ECONNABORTED || errno == ECONNRESET || errno == ETIMEDOUT || errno == ENETRESET || errno == ENOTCONN || errno == EPIPE)
+					{
+						return sf::Socket::Disconnected;
+					}
+					return sf::Socket::Error;
+				}
+			#endif
+		}
+	};
+	
 	/**
 	 * @brief TCP socket
 	 * 
 	 * @code
 	   #include <thoth/tcp.hpp>
 	   @endcode
+	 * 
+	 * The data are sent as a sf::Packet (a sf::Packet or a thoth::tcp_reactor can receive them).
+	 * send and receive reuse the packet and the buffer of the socket, so they do not allocate once the buffers are large enough.
+	 * send_fixed and receive_fixed use a buffer on the stack whose size is known at compile time
+	 * (only for fixed-size fields, see thoth::packet_layout).
 	 */
 	class tcp
 	{
@@ -75,13 +350,25 @@ namespace thoth
 		/// thoth::tcp_listener is friend
 		friend class thoth::tcp_listener;
 		
+		/// thoth::tcp_reactor is friend
+		friend class thoth::tcp_reactor;
+		
 	private:
 		
 		/// Port
 		unsigned short int m_port;
 		
 		/// TCP socket
-		sf::TcpSocket m_socket;
+		thoth::tcp_socket m_socket;
+		
+		/// Reused packet to send
+		sf::Packet m_packet_send;
+		
+		/// Reused packet to receive
+		sf::Packet m_packet_receive;
+		
+		/// Reused buffer to receive
+		std::vector<char> m_receive_buffer;
 		
 		/// Function to be called after connection
 		std::function<void (thoth::tcp & socket)> m_function;
@@ -105,6 +392,9 @@ namespace thoth
 		) :
 			m_port(port),
 			m_socket(),
+			m_packet_send(),
+			m_packet_receive(),
+			m_receive_buffer(),
 			m_function(function),
 			m_thread
 			(
@@ -138,11 +428,12 @@ namespace thoth
 		
 		/// @brief Send data
 		/// @param[in] args Data
+		/// @return the status of the socket (sf::Socket::Done if the data are sent or in the outgoing buffer of a non-blocking socket)
 		template <class ... args_t>
-		void send(args_t const & ... args)
+		sf::Socket::Status send(args_t const & ... args)
 		{
-			sf::Packet packet;
-			send(packet, args...);
+			m_packet_send.clear();
+			return send(m_packet_send, args...);
 		}
 		
 		/// @brief Receive data
@@ -150,28 +441,92 @@ namespace thoth
 		template <class ... args_t>
 		void receive(args_t & ... args)
 		{
-			sf::Packet packet;
-			m_socket.receive(packet);
-			receive(packet, args...);
+			char header[4];
+			if (m_socket.receive_all(header, sizeof(header)) != sf::Socket::Done) { return; }
+			std::size_t const size = thoth::packet_read_big_endian<sf::Uint32>(header);
+			
+			m_receive_buffer.resize(size);
+			if (size != 0 && m_socket.receive_all(m_receive_buffer.data(), size) != sf::Socket::Done) { return; }
+			
+			m_packet_receive.clear();
+			m_packet_receive.append(m_receive_buffer.data(), size);
+			receive(m_packet_receive, args...);
+		}
+		
+		/// @brief Send fixed-size data with a buffer on the stack
+		/// @param[in] args Data (see thoth::packet_layout)
+		/// @return the status of the socket
+		template <class ... args_t>
+		sf::Socket::Status send_fixed(args_t const & ... args)
+		{
+			using layout = thoth::packet_layout<args_t...>;
+			std::array<char, 4 + layout::size> buffer;
+			thoth::packet_write_big_endian(buffer.data(), sf::Uint32(layout::size));
+			layout::write(buffer.data() + 4, args...);
+			return m_socket.send_gather(buffer.data(), buffer.size(), nullptr, 0);
+		}
+		
+		/// @brief Receive fixed-size data with a buffer on the stack
+		/// @param[out] args Data (see thoth::packet_layout)
+		/// @return false if the socket fails or if the size of the packet is not the size of the data, true otherwise
+		template <class ... args_t>
+		bool receive_fixed(args_t & ... args)
+		{
+			using layout = thoth::packet_layout<args_t...>;
+			std::array<char, 4 + layout::size> buffer;
+			if (m_socket.receive_all(buffer.data(), 4) != sf::Socket::Done) { return false; }
+			std::size_t const size = thoth::packet_read_big_endian<sf::Uint32>(buffer.data());
+			
+			if (size != layout::size)
+			{
+				// Skip the packet
+				m_receive_buffer.resize(size);
+				if (size != 0) { m_socket.receive_all(m_receive_buffer.data(), size); }
+				return false;
+			}
+			
+			if (m_socket.receive_all(buffer.data() + 4, layout::size) != sf::Socket::Done) { return false; }
+			layout::read(buffer.data() + 4, args...);
+			return true;
+		}
+		
+		/// @brief Send fixed-size data followed by a payload without copying the payload
+		/// @param[in] payload      Payload (received as a std::string after the fields)
+		/// @param[in] payload_size Size of the payload
+		/// @param[in] args         Data before the payload (see thoth::packet_layout)
+		/// @return the status of the socket
+		template <class ... args_t>
+		sf::Socket::Status send_with_payload(void const * const payload, std::size_t const payload_size, args_t const & ... args)
+		{
+			using layout = thoth::packet_layout<args_t...>;
+			std::array<char, 4 + layout::size + 4> buffer;
+			thoth::packet_write_big_endian(buffer.data(), sf::Uint32(layout::size + 4 + payload_size));
+			layout::write(buffer.data() + 4, args...);
+			thoth::packet_write_big_endian(buffer.data() + 4 + layout::size, sf::Uint32(payload_size));
+			return m_socket.send_gather(buffer.data(), buffer.size(), payload, payload_size);
 		}
 		
 	private:
 		
-		/// @brief Send data
+		/// @brief Send data (end of thoth::tcp::send)
 		/// @param[in] packet Data
-		void send(sf::Packet & packet)
+		/// @return the status of the socket
+		sf::Socket::Status send(sf::Packet & packet)
 		{
-			m_socket.send(packet);
+			char header[4];
+			thoth::packet_write_big_endian(header, sf::Uint32(packet.getDataSize()));
+			return m_socket.send_gather(header, sizeof(header), packet.getData(), packet.getDataSize());
 		}
 		
 		/// @brief Send data
 		/// @param[in] packet Data
 		/// @param[in] args   Data
+		/// @return the status of the socket
 		template <class T, class ... args_t>
-		void send(sf::Packet & packet, T const & t, args_t const & ... args)
+		sf::Socket::Status send(sf::Packet & packet, T const & t, args_t const & ... args)
 		{
 			packet << t;
-			send(packet, args...);
+			return send(packet, args...);
 		}
 		
 		/// @brief Receive data (end of thoth::tcp::receive)
@@ -221,8 +576,8 @@ namespace thoth
 		/// To run functions
 		std::vector<std::thread> m_threads;
 		
-		/// Can accept connection
-		bool m_can_accept;
+		/// Can accept connection (written by the destructor, read by the accepting thread)
+		std::atomic<bool> m_can_accept;
 		
 		/// To accept connections
 		std::thread m_thread_accept;
@@ -0,0 +1,346 @@
+// Copyright © 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of Thōth.
+
+// Thōth is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Thōth is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with Thōth. If not, see <http://www.gnu.org/licenses/>
+
+
+#ifndef THOTH_TCP_REACTOR_HPP
+#define THOTH_TCP_REACTOR_HPP
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <SFML/Network.hpp>
+
+#ifndef SFML_SYSTEM_WINDOWS
+	#include <sys/select.h>
+#else
+	#include <winsock2.h>
+#endif
+
+#include "tcp.hpp"
+
+
+namespace thoth
+{
+	/**
+	 * @brief TCP server where a fixed number of threads multiplex all the connections
+	 * 
+	 * @code
+	   #include <thoth/tcp_reactor.hpp>
+	   @endcode
+	 * 
+	 * Unlike thoth::tcp_listener (one thread per connection), each I/O thread waits on its own
+	 * sf::SocketSelector and calls the per-connection functions when a packet is received. @n
+	 * The first I/O thread also accepts the new connections and gives each one to the I/O thread
+	 * with the fewest connections. @n
+	 * Hundreds of clients cost nb_io_thread threads.
+	 * 
+	 * @note The functions are called on the I/O threads, they must not block. @n
+	 * The sockets are in non-blocking mode, a slow client does not stall the other connections:
+	 * - a packet partially received is kept by its socket and completed when the rest arrives
+	 * - a packet which can not be sent now waits in the outgoing buffer of its socket (see thoth::tcp_socket),
+	 *   the outgoing buffers are sent at each wake up of the I/O thread (a receive or the timeout, 50 ms)
+	 * - a client whose outgoing buffer is full (it does not read) is disconnected
+	 * 
+	 * sf::SocketSelector uses select, the number of connections is limited by FD_SETSIZE.
+	 * 
+	 * @code
+	   thoth::tcp_reactor server
+	   (
+	   	53000,
+	   	[](thoth::tcp & socket, sf::Packet & packet)
+	   	{
+	   		std::string s;
+	   		packet >> s;
+	   		socket.send(s);
+	   	}
+	   );
+	   @endcode
+	 */
+	class tcp_reactor
+	{
+	public:
+		
+		/// Max number of connections of sf::SocketSelector (FD_SETSIZE, minus the listener)
+		static std::size_t const max_connection_limit = std::size_t(FD_SETSIZE) - 1;
+		
+		/// Function called for a connection or a disconnection
+		using connection_function_t = std::function<void (thoth::tcp & socket)>;
+		
+		/// Function called for a received packet
+		using receive_function_t = std::function<void (thoth::tcp & socket, sf::Packet & packet)>;
+		
+	private:
+		
+		/**
+		 * @brief I/O thread: a selector and its connections
+		 */
+		class io_thread
+		{
+		public:
+			
+			/// Selector
+			sf::SocketSelector selector;
+			
+			/// Connections (only used by the I/O thread)
+			std::vector<std::unique_ptr<thoth::tcp>> sockets;
+			
+			/// New connections given by the accepting thread
+			std::vector<std::unique_ptr<thoth::tcp>> inbox;
+			
+			/// Protects inbox
+			std::mutex inbox_mutex;
+			
+			/// Number of connections (sockets + inbox)
+			std::atomic<std::size_t> nb_connection;
+			
+			/// Thread
+			std::thread thread;
+			
+			/// @brief Constructor
+			io_thread() : selector(), sockets(), inbox(), inbox_mutex(), nb_connection(0), thread()
+			{ }
+		};
+		
+		/// Port
+		unsigned short int m_port;
+		
+		/// TCP listener
+		sf::TcpListener m_listener;
+		
+		/// Max number of connections
+		std::size_t const m_max_connection;
+		
+		/// Function called for a received packet
+		receive_function_t m_on_receive;
+		
+		/// Function called for a new connection
+		connection_function_t m_on_connect;
+		
+		/// Function called for a disconnection
+		connection_function_t m_on_disconnect;
+		
+		/// Time of one selector wait (new connections and stop are checked between two waits)
+		sf::Time const m_timeout;
+		
+		/// I/O threads are running
+		std::atomic<bool> m_running;
+		
+		/// I/O threads
+		std::vector<std::unique_ptr<io_thread>> m_io_threads;
+		
+	public:
+		
+		/// @brief Constructor
+		/// @param[in] port           Port of the server
+		/// @param[in] on_receive     Function called for a received packet
+		/// @param[in] on_connect     Function called for a new connection (nullptr by default)
+		/// @param[in] on_disconnect  Function called for a disconnection (nullptr by default)
+		/// @param[in] nb_io_thread   Number of I/O threads (std::thread::hardware_concurrency() by default)
+		/// @param[in] max_connection Max number of connections (thoth::tcp_reactor::max_connection_limit by default, std::invalid_argument is thrown if it is greater)
+		tcp_reactor
+		(
+			unsigned short int const port,
+			receive_function_t on_receive,
+			connection_function_t on_connect = nullptr,
+			connection_function_t on_disconnect = nullptr,
+			std::size_t const nb_io_thread = std::max(1u, std::thread::hardware_concurrency()),
+			std::size_t const max_connection = thoth::tcp_reactor::max_connection_limit
+		) :
+			m_port(port),
+			m_listener(),
+			m_max_connection(max_connection),
+			m_on_receive(on_receive),
+			m_on_connect(on_connect),
+			m_on_disconnect(on_disconnect),
+			m_timeout(sf::milliseconds(50)),
+			m_running(true),
+			m_io_threads()
+		{
+			if (max_connection > thoth::tcp_reactor::max_connection_limit)
+			{
+				throw std::invalid_argument
+				(
+					"thoth::tcp_reactor: max_connection = " + std::to_string(max_connection) +
+					" is greater than FD_SETSIZE - 1 = " + std::to_string(thoth::tcp_reactor::max_connection_limit)
+				);
+			}
+			
+			auto const r = m_listener.listen(m_port);
+			if (r != sf::Socket::Done)
+			{
+				std::cerr << "thoth::tcp_reactor: " << r << std::endl;
+			}
+			
+			for (std::size_t i = 0; i < std::max(std::size_t(1), nb_io_thread); ++i)
+			{
+				m_io_threads.emplace_back(new io_thread());
+			}
+			
+			// The first I/O thread accepts the connections
+			if (r == sf::Socket::Done)
+			{
+				m_io_threads[0]->selector.add(m_listener);
+			}
+			
+			for (auto & io : m_io_threads)
+			{
+				io_thread & io_ref = *io;
+				io->thread = std::thread([this, &io_ref]() -> void { run(io_ref); });
+			}
+		}
+		
+		/// @brief Destructor
+		~tcp_reactor()
+		{
+			m_running = false;
+			
+			for (auto & io : m_io_threads) { io->thread.join(); }
+			
+			for (auto & io : m_io_threads)
+			{
+				for (auto & socket : io->sockets) { socket->disconnect(); }
+				for (auto & socket : io->inbox) { socket->disconnect(); }
+			}
+			
+			m_listener.close();
+		}
+		
+		/// @brief Return the number of I/O threads
+		/// @return the number of I/O threads
+		std::size_t nb_io_thread() const { return m_io_threads.size(); }
+		
+		/// @brief Return the number of connections
+		/// @return the number of connections
+		std::size_t nb_connection() const
+		{
+			std::size_t n = 0;
+			for (auto const & io : m_io_threads) { n += io->nb_connection; }
+			return n;
+		}
+		
+	private:
+		
+		/// @brief I/O thread
+		/// @param[in,out] io The I/O thread
+		void run(io_thread & io)
+		{
+			sf::Packet packet;
+			std::vector<std::unique_ptr<thoth::tcp>> inbox;
+			
+			while (m_running)
+			{
+				// New connections
+				{
+					{
+						std::lock_guard<std::mutex> lock(io.inbox_mutex);
+						inbox.swap(io.inbox);
+					}
+					for (auto & socket : inbox)
+					{
+						io.selector.add(socket->m_socket);
+						io.sockets.push_back(std::move(socket));
+						if (m_on_connect) { m_on_connect(*io.sockets.back()); }
+					}
+					inbox.clear();
+				}
+				
+				bool const is_ready = io.selector.wait(m_timeout);
+				
+				if (is_ready && &io == m_io_threads[0].get() && io.selector.isReady(m_listener))
+				{
+					accept();
+				}
+				
+				for (std::size_t i = 0; i < io.sockets.size(); )
+				{
+					thoth::tcp & socket = *io.sockets[i];
+					
+					// Outgoing buffer (sf::SocketSelector does not wait for the writes)
+					auto r = socket.m_socket.flush();
+					
+					if (r != sf::Socket::Disconnected && r != sf::Socket::Error && is_ready && io.selector.isReady(socket.m_socket))
+					{
+						packet.clear();
+						r = socket.m_socket.receive(packet);
+						
+						if (r == sf::Socket::Done)
+						{
+							if (m_on_receive) { m_on_receive(socket, packet); }
+						}
+						else if (r == sf::Socket::NotReady)
+						{
+							// Partial packet, SFML keeps the received part until the rest arrives
+						}
+					}
+					
+					// Disconnected, error, or a send failed (the outgoing buffer is full when the client does not read)
+					if (r == sf::Socket::Disconnected || r == sf::Socket::Error || socket.m_socket.send_failed())
+					{
+						if (m_on_disconnect) { m_on_disconnect(socket); }
+						io.selector.remove(socket.m_socket);
+						socket.disconnect();
+						io.sockets[i] = std::move(io.sockets.back());
+						io.sockets.pop_back();
+						--io.nb_connection;
+						continue;
+					}
+					
+					++i;
+				}
+			}
+		}
+		
+		/// @brief Accept one client and give it to the least loaded I/O thread
+		void accept()
+		{
+			std::unique_ptr<thoth::tcp> socket(new thoth::tcp());
+			
+			if (m_listener.accept(socket->m_socket) != sf::Socket::Done) { return; }
+			
+			// A client which sends half a packet must not block the I/O thread
+			socket->m_socket.setBlocking(false);
+			
+			if (nb_connection() >= m_max_connection)
+			{
+				socket->disconnect();
+				return;
+			}
+			
+			io_thread & io = **std::min_element
+			(
+				m_io_threads.begin(), m_io_threads.end(),
+				[](std::unique_ptr<io_thread> const & a, std::unique_ptr<io_thread> const & b) -> bool
+				{
+					return a->nb_connection < b->nb_connection;
+				}
+			);
+			
+			++io.nb_connection;
+			std::lock_guard<std::mutex> lock(io.inbox_mutex);
+			io.inbox.push_back(std::move(socket));
+		}
+	};
+}
+
+#endif
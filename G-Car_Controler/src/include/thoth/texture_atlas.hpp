@@ -0,0 +1,204 @@
+// Copyright © 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of Thōth.
+
+// Thōth is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Thōth is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with Thōth. If not, see <http://www.gnu.org/licenses/>
+
+
+#ifndef THOTH_TEXTURE_ATLAS_HPP
+#define THOTH_TEXTURE_ATLAS_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+
+namespace thoth
+{
+	/**
+	 * @brief Place of an image in a thoth::texture_atlas
+	 * 
+	 * @code
+	   #include <thoth/texture_atlas.hpp>
+	   @endcode
+	 */
+	class atlas_region
+	{
+	public:
+		
+		/// Index of the page
+		std::size_t page;
+		
+		/// Rectangle of the image in the page (in pixels)
+		sf::IntRect rect;
+	};
+	
+	/**
+	 * @brief Texture atlas: many images packed in a few big textures (the pages)
+	 * 
+	 * @code
+	   #include <thoth/texture_atlas.hpp>
+	   @endcode
+	 * 
+	 * Sprites whose textures are in the same page can be drawn with one draw call (see thoth::sprite_batch). @n
+	 * The images are packed with a shelf algorithm (sorted by decreasing height, placed left to right on shelves). @n
+	 * Each image is surrounded by padding pixels which repeat its border (no bleeding with smooth textures). @n
+	 * An image bigger than a page is not packed.
+	 * 
+	 * @code
+	   thoth::texture_atlas atlas;
+	   atlas.add("grass", grass_image);
+	   atlas.add("water", water_image);
+	   atlas.build();
+	   thoth::atlas_region const * region = atlas.find("grass");
+	   @endcode
+	 */
+	class texture_atlas
+	{
+	private:
+		
+		/// Images to pack (cleared after build)
+		std::vector<std::pair<std::string, sf::Image>> m_images;
+		
+		/// Pages
+		std::vector<std::unique_ptr<sf::Texture>> m_pages;
+		
+		/// Regions of the packed images
+		std::unordered_map<std::string, thoth::atlas_region> m_regions;
+		
+	public:
+		
+		/// @brief Add an image to pack with the next build
+		/// @param[in] key   Key of the image
+		/// @param[in] image Image
+		void add(std::string const & key, sf::Image const & image)
+		{
+			m_images.emplace_back(key, image);
+		}
+		
+		/**
+		 * @brief Pack the added images into pages
+		 * 
+		 * The previous pages are removed.
+		 * 
+		 * @param[in] page_size Size of a page (limited by sf::Texture::getMaximumSize())
+		 * @param[in] padding   Number of pixels around each image
+		 */
+		void build(unsigned int const page_size = 2048, unsigned int const padding = 1)
+		{
+			m_pages.clear();
+			m_regions.clear();
+			
+			unsigned int const size = std::min(page_size, sf::Texture::getMaximumSize());
+			
+			// Highest images first
+			std::vector<std::size_t> order(m_images.size());
+			for (std::size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+			std::stable_sort
+			(
+				order.begin(), order.end(),
+				[&](std::size_t const a, std::size_t const b) { return m_images[a].second.getSize().y > m_images[b].second.getSize().y; }
+			);
+			
+			// Shelf packing
+			std::vector<sf::Image> pages;
+			unsigned int x = 0;
+			unsigned int y = 0;
+			unsigned int shelf_height = 0;
+			for (std::size_t const i : order)
+			{
+				sf::Image const & image = m_images[i].second;
+				unsigned int const w = image.getSize().x + 2 * padding;
+				unsigned int const h = image.getSize().y + 2 * padding;
+				if (image.getSize().x == 0 || image.getSize().y == 0 || w > size || h > size) { continue; }
+				
+				// New shelf
+				if (x + w > size) { x = 0; y += shelf_height; shelf_height = 0; }
+				// New page
+				if (pages.empty() || y + h > size)
+				{
+					pages.emplace_back();
+					pages.back().create(size, size, sf::Color::Transparent);
+					x = 0; y = 0; shelf_height = 0;
+				}
+				
+				thoth::atlas_region const region{ pages.size() - 1, sf::IntRect(int(x + padding), int(y + padding), int(image.getSize().x), int(image.getSize().y)) };
+				blit(pages.back(), image, region.rect, padding);
+				m_regions[m_images[i].first] = region;
+				
+				x += w;
+				shelf_height = std::max(shelf_height, h);
+			}
+			
+			// Upload the pages
+			for (sf::Image const & page : pages)
+			{
+				m_pages.emplace_back(new sf::Texture());
+				m_pages.back()->loadFromImage(page);
+				m_pages.back()->setSmooth(true);
+			}
+			
+			m_images.clear();
+			m_images.shrink_to_fit();
+		}
+		
+		/// @brief Return the number of pages
+		/// @return the number of pages
+		std::size_t nb_page() const { return m_pages.size(); }
+		
+		/// @brief Return a page
+		/// @param[in] i Index of the page
+		/// @return the texture of the page
+		sf::Texture const & page(std::size_t const i) const { return *m_pages[i]; }
+		
+		/// @brief Return the region of an image
+		/// @param[in] key Key of the image
+		/// @return the region of the image, nullptr if the image is not packed
+		thoth::atlas_region const * find(std::string const & key) const
+		{
+			auto const it = m_regions.find(key);
+			return (it == m_regions.end()) ? nullptr : &it->second;
+		}
+		
+	private:
+		
+		/// @brief Copy an image in a page and repeat its border in the padding
+		/// @param[in,out] page    Page
+		/// @param[in]     image   Image
+		/// @param[in]     rect    Rectangle of the image in the page
+		/// @param[in]     padding Number of pixels around the image
+		static void blit(sf::Image & page, sf::Image const & image, sf::IntRect const & rect, unsigned int const padding)
+		{
+			page.copy(image, unsigned(rect.left), unsigned(rect.top));
+			
+			int const w = rect.width;
+			int const h = rect.height;
+			for (unsigned int p = 1; p <= padding; ++p)
+			{
+				page.copy(image, unsigned(rect.left), unsigned(rect.top) - p, sf::IntRect(0, 0, w, 1));
+				page.copy(image, unsigned(rect.left), unsigned(rect.top + h - 1) + p, sf::IntRect(0, h - 1, w, 1));
+				page.copy(image, unsigned(rect.left) - p, unsigned(rect.top), sf::IntRect(0, 0, 1, h));
+				page.copy(image, unsigned(rect.left + w - 1) + p, unsigned(rect.top), sf::IntRect(w - 1, 0, 1, h));
+			}
+		}
+	};
+}
+
+#endif
@@ -33,6 +33,7 @@
 #include <SFML/Graphics/Texture.hpp>
 
 #include "media.hpp"
+#include "texture_atlas.hpp"
 #include "to_hnc.hpp"
 #include "to_sfml.hpp"
 
@@ -65,6 +66,9 @@ namespace thoth
 		/// Image
 		hnc::optional<hnc::vector2D<hnc::color>> m_image;
 		
+		/// Place in thoth::textures().atlas()
+		hnc::optional<thoth::atlas_region> m_atlas_region;
+		
 	public:
 		
 		/// @brief Default constructor
@@ -81,7 +85,8 @@ namespace thoth
 			m_key(key),
 			m_filename(texture_filename),
 			m_texture(),
-			m_image()
+			m_image(),
+			m_atlas_region()
 		{
 			m_texture.loadFromFile(texture_filename);
 			m_texture.setSmooth(true);
@@ -98,7 +103,8 @@ namespace thoth
 			m_key(key),
 			m_filename(),
 			m_texture(),
-			m_image()
+			m_image(image),
+			m_atlas_region()
 		{
 			sf::Image image_sfml = thoth::to_sfml(image);
 			m_texture.loadFromImage(image_sfml);
@@ -135,6 +141,20 @@ namespace thoth
 			return m_texture;
 		}
 		
+		/// @brief Return the place of the texture in thoth::textures().atlas()
+		/// @return the region in the atlas, nullptr if the texture is not in the atlas
+		thoth::atlas_region const * region_in_atlas() const
+		{
+			return (bool(m_atlas_region)) ? &(*m_atlas_region) : nullptr;
+		}
+		
+		/// @brief Set the place of the texture in thoth::textures().atlas() (used by thoth::textures_t::build_atlas)
+		/// @param[in] region Region in the atlas, nullptr if the texture is not in the atlas
+		void set_region_in_atlas(thoth::atlas_region const * const region)
+		{
+			m_atlas_region = (region == nullptr) ? hnc::optional<thoth::atlas_region>() : hnc::optional<thoth::atlas_region>(*region);
+		}
+		
 		/// @brief Return the image, a hnc::vector2D<hnc::color>
 		/// @return the image
 		hnc::vector2D<hnc::color> const & image() const
@@ -193,6 +213,9 @@ namespace thoth
 		/// Textures
 		std::unordered_map<std::string, thoth::texture> m_textures;
 		
+		/// Atlas of the textures
+		thoth::texture_atlas m_atlas;
+		
 	public:
 		
 		/// @brief Add a texture from filename
@@ -250,6 +273,39 @@ namespace thoth
 		{
 			return m_textures.at(key).load_image();
 		}
+		
+		/**
+		 * @brief Pack all loaded textures into the pages of the atlas
+		 * 
+		 * Call it once the textures are loaded (a texture loaded after is drawn alone by thoth::sprite_batch). @n
+		 * The textures are read back from the graphic card, an OpenGL context is needed.
+		 * 
+		 * @param[in] page_size Size of a page (2048 by default)
+		 * @param[in] padding   Number of pixels around each texture (1 by default)
+		 * @return the atlas
+		 */
+		thoth::texture_atlas const & build_atlas(unsigned int const page_size = 2048, unsigned int const padding = 1)
+		{
+			for (auto const & key_texture : m_textures)
+			{
+				m_atlas.add(key_texture.first, key_texture.second.texture_sfml().copyToImage());
+			}
+			m_atlas.build(page_size, padding);
+			
+			for (auto & key_texture : m_textures)
+			{
+				key_texture.second.set_region_in_atlas(m_atlas.find(key_texture.first));
+			}
+			
+			return m_atlas;
+		}
+		
+		/// @brief Return the atlas of the textures (empty before build_atlas)
+		/// @return the atlas
+		thoth::texture_atlas const & atlas() const
+		{
+			return m_atlas;
+		}
 	};
 	
 	/**
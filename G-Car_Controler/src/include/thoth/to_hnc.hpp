@@ -28,6 +28,9 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Image.hpp>
+
+#include "transpose_rgba8.hpp"
 
 
 namespace thoth
@@ -95,15 +98,14 @@ namespace thoth
 	 */
 	inline hnc::vector2D<hnc::color> to_hnc(sf::Image const & image)
 	{
+		static_assert(sizeof(hnc::color) == 4, "thoth::to_hnc: hnc::color must be 4 bytes (RGBA8)");
+		
 		hnc::vector2D<hnc::color> image_hnc(image.getSize().x, image.getSize().y);
 		
-		for (std::size_t i = 0; i < image_hnc.nb_row(); ++i)
+		// sf::Image is stored row by row, image(x, y) column by column
+		if (image_hnc.nb_row() != 0 && image_hnc.nb_col() != 0)
 		{
-			for (std::size_t j = 0; j < image_hnc.nb_col(); ++j)
-			{
-				auto const color_sfml = image.getPixel(hnc::uint_t(i), hnc::uint_t(j));
-				image_hnc(i, j) = thoth::to_hnc(color_sfml);
-			}
+			thoth::transpose_rgba8(image.getPixelsPtr(), image_hnc.nb_col(), image_hnc.nb_row(), image_hnc.data());
 		}
 		
 		return image_hnc;
@@ -26,9 +26,12 @@
 #include <hnc/int.hpp>
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Rect.hpp>
 
+#include "transpose_rgba8.hpp"
+
 
 namespace thoth
 {
@@ -95,16 +98,14 @@ namespace thoth
 	 */
 	inline sf::Image to_sfml(hnc::vector2D<hnc::color> const & image)
 	{
-		sf::Image image_sfml;
-		image_sfml.create(hnc::uint_t(image.nb_row()), hnc::uint_t(image.nb_col()));
+		static_assert(sizeof(hnc::color) == 4, "thoth::to_sfml: hnc::color must be 4 bytes (RGBA8)");
 		
-		for (std::size_t i = 0; i < std::size_t(image_sfml.getSize().x); ++i)
-		{
-			for (std::size_t j = 0; j < std::size_t(image_sfml.getSize().y); ++j)
-			{
-				image_sfml.setPixel(hnc::uint_t(i), hnc::uint_t(j), thoth::to_sfml(image(i, j)));
-			}
-		}
+		// image(x, y) is stored column by column, sf::Image row by row
+		std::vector<sf::Uint8> pixels(image.nb_row() * image.nb_col() * 4);
+		thoth::transpose_rgba8(image.data(), image.nb_row(), image.nb_col(), pixels.data());
+		
+		sf::Image image_sfml;
+		image_sfml.create(hnc::uint_t(image.nb_row()), hnc::uint_t(image.nb_col()), pixels.data());
 		
 		return image_sfml;
 	}
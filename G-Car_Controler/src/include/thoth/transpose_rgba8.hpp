@@ -0,0 +1,158 @@
+// Copyright © 2014 Lénaïc Bagnères, hnc@singularity.fr
+
+// This file is part of Thōth.
+
+// Thōth is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Thōth is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with Thōth. If not, see <http://www.gnu.org/licenses/>
+
+#ifndef THOTH_TRANSPOSE_RGBA8_HPP
+#define THOTH_TRANSPOSE_RGBA8_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+
+namespace thoth
+{
+	/**
+	 * @brief Transpose an image of 4-byte pixels (RGBA8)
+	 * 
+	 * @code
+	   #include <thoth/transpose_rgba8.hpp>
+	   @endcode
+	 * 
+	 * out[j][i] = in[i][j], both images are contiguous (no padding between the rows). @n
+	 * The image is processed by tiles (to stay in the cache) of 8x8 blocks with AVX2, 4x4 blocks with SSE2,
+	 * or pixel by pixel without SIMD (the instruction set is chosen at compile time).
+	 * 
+	 * hnc::vector2D<hnc::color> stores the pixels column by column (image(x, y)) and
+	 * sf::Image stores them row by row, so the conversion between them is a transposition.
+	 * 
+	 * @param[in]  in     Input image (nb_row * nb_col pixels)
+	 * @param[in]  nb_row Number of rows of the input image
+	 * @param[in]  nb_col Number of columns of the input image
+	 * @param[out] out    Output image (nb_col * nb_row pixels, must not overlap the input)
+	 */
+	inline void transpose_rgba8(void const * const in, std::size_t const nb_row, std::size_t const nb_col, void * const out)
+	{
+		char const * const src = static_cast<char const *>(in);
+		char * const dst = static_cast<char *>(out);
+		
+		// Scalar copy of one pixel
+		auto const copy_pixel = [&](std::size_t const i, std::size_t const j)
+		{
+			std::memcpy(dst + 4 * (j * nb_row + i), src + 4 * (i * nb_col + j), 4);
+		};
+		
+		#if defined(__AVX2__)
+			std::size_t const block = 8;
+		#elif defined(__SSE2__)
+			std::size_t const block = 4;
+		#else
+			std::size_t const block = 1;
+		#endif
+		
+		// Tiles of 64x64 pixels (16 KiB in, 16 KiB out)
+		std::size_t const tile = 64;
+		
+		for (std::size_t i_tile = 0; i_tile < nb_row; i_tile += tile)
+		{
+			std::size_t const i_end = std::min(i_tile + tile, nb_row);
+			std::size_t const i_end_block = i_tile + (i_end - i_tile) / block * block;
+			
+			for (std::size_t j_tile = 0; j_tile < nb_col; j_tile += tile)
+			{
+				std::size_t const j_end = std::min(j_tile + tile, nb_col);
+				std::size_t const j_end_block = j_tile + (j_end - j_tile) / block * block;
+				
+				// Blocks
+				for (std::size_t i = i_tile; i < i_end_block; i += block)
+				{
+					for (std::size_t j = j_tile; j < j_end_block; j += block)
+					{
+						#if defined(__AVX2__)
+							auto const load = [&](std::size_t const k)
+							{
+								return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 4 * ((i + k) * nb_col + j)));
+							};
+							__m256i const r0 = load(0), r1 = load(1), r2 = load(2), r3 = load(3);
+							__m256i const r4 = load(4), r5 = load(5), r6 = load(6), r7 = load(7);
+							
+							__m256i const t0 = _mm256_unpacklo_epi32(r0, r1), t1 = _mm256_unpackhi_epi32(r0, r1);
+							__m256i const t2 = _mm256_unpacklo_epi32(r2, r3), t3 = _mm256_unpackhi_epi32(r2, r3);
+							__m256i const t4 = _mm256_unpacklo_epi32(r4, r5), t5 = _mm256_unpackhi_epi32(r4, r5);
+							__m256i const t6 = _mm256_unpacklo_epi32(r6, r7), t7 = _mm256_unpackhi_epi32(r6, r7);
+							
+							__m256i const u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+							__m256i const u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+							__m256i const u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+							__m256i const u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+							
+							auto const store = [&](std::size_t const k, __m256i const v)
+							{
+								_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * ((j + k) * nb_row + i)), v);
+							};
+							store(0, _mm256_permute2x128_si256(u0, u4, 0x20));
+							store(1, _mm256_permute2x128_si256(u1, u5, 0x20));
+							store(2, _mm256_permute2x128_si256(u2, u6, 0x20));
+							store(3, _mm256_permute2x128_si256(u3, u7, 0x20));
+							store(4, _mm256_permute2x128_si256(u0, u4, 0x31));
+							store(5, _mm256_permute2x128_si256(u1, u5, 0x31));
+							store(6, _mm256_permute2x128_si256(u2, u6, 0x31));
+							store(7, _mm256_permute2x128_si256(u3, u7, 0x31));
+						#elif defined(__SSE2__)
+							auto const load = [&](std::size_t const k)
+							{
+								return _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 4 * ((i + k) * nb_col + j)));
+							};
+							__m128i const r0 = load(0), r1 = load(1), r2 = load(2), r3 = load(3);
+							
+							__m128i const t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+							__m128i const t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+							
+							auto const store = [&](std::size_t const k, __m128i const v)
+							{
+								_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * ((j + k) * nb_row + i)), v);
+							};
+							store(0, _mm_unpacklo_epi64(t0, t1));
+							store(1, _mm_unpackhi_epi64(t0, t1));
+							store(2, _mm_unpacklo_epi64(t2, t3));
+							store(3, _mm_unpackhi_epi64(t2, t3));
+						#else
+							copy_pixel(i, j);
+						#endif
+					}
+				}
+				
+				// Right and bottom borders of the tile
+				for (std::size_t i = i_tile; i < i_end; ++i)
+				{
+					for (std::size_t j = (i < i_end_block) ? j_end_block : j_tile; j < j_end; ++j)
+					{
+						copy_pixel(i, j);
+					}
+				}
+			}
+		}
+	}
+}
+
+#endif
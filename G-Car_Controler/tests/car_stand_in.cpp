@@ -0,0 +1,113 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <SFML/Network.hpp>
+
+#include <g-car/network/command.hpp>
+#include <g-car/network/telemetry.hpp>
+
+
+// Stand-in for the G-Car: connects to the controller, displays the decoded commands
+// and sends fake telemetry (infrared at 1 kHz, velocity and distance at 50 Hz)
+// ./test__car_stand_in [ip of the controller]
+int main(int argc, char * argv[])
+{
+	std::string const ip = (argc > 1) ? argv[1] : "localhost";
+	
+	sf::TcpSocket socket;
+	if (socket.connect(ip, 54000) != sf::Socket::Done)
+	{
+		std::cerr << "Can not connect to the controller " << ip << ":54000" << std::endl;
+		return 1;
+	}
+	
+	// Telemetry
+	std::atomic<bool> running(true);
+	std::thread telemetry
+	(
+		[&]()
+		{
+			auto const start = std::chrono::steady_clock::now();
+			std::uint16_t sequence = 0;
+			float distance = 0.f;
+			
+			for (std::uint32_t ms = 0; running; ++ms)
+			{
+				std::this_thread::sleep_until(start + std::chrono::milliseconds(ms));
+				
+				gcar::network::telemetry_sample sample;
+				sample.timestamp = ms;
+				gcar::network::telemetry_buffer buffer;
+				
+				sample.sensor = gcar::network::sensor::infrared;
+				sample.sequence = sequence++;
+				sample.value = 50.f + 20.f * std::sin(float(ms) / 100.f);
+				gcar::network::encode(sample, buffer.data());
+				if (socket.send(buffer.data(), buffer.size()) != sf::Socket::Done) { return; }
+				
+				if (ms % 20 == 0)
+				{
+					float const velocity = 1.f + std::sin(float(ms) / 1000.f);
+					distance += velocity * 0.02f;
+					
+					sample.sensor = gcar::network::sensor::velocity;
+					sample.sequence = sequence++;
+					sample.value = velocity;
+					gcar::network::encode(sample, buffer.data());
+					socket.send(buffer.data(), buffer.size());
+					
+					sample.sensor = gcar::network::sensor::distance;
+					sample.sequence = sequence++;
+					sample.value = distance;
+					gcar::network::encode(sample, buffer.data());
+					socket.send(buffer.data(), buffer.size());
+				}
+			}
+		}
+	);
+	
+	gcar::network::command_parser parser;
+	
+	char data[256];
+	std::size_t received;
+	
+	while (socket.receive(data, sizeof(data), received) == sf::Socket::Done)
+	{
+		parser.feed
+		(
+			data, received,
+			[](gcar::network::command const & command)
+			{
+				std::cout << "#" << command.sequence << " t=" << command.timestamp << "ms"
+				          << " opcode " << int(command.op)
+				          << " A " << command.a << " C " << command.c << " D " << command.d << std::endl;
+			}
+		);
+	}
+	
+	running = false;
+	telemetry.join();
+	
+	std::cout << "Disconnected (" << parser.nb_invalid() << " invalid frames)" << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright © 2015 Rodolphe Cargnello, rodolphe.cargnello@gmail.com
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <SFML/Network.hpp>
+
+#include <thoth/tcp_reactor.hpp>
+
+
+// Test of thoth::tcp_reactor: a client which does not read its replies and a client which sends
+// half a packet must not stall the other connections (they share the I/O threads)
+// ./test__tcp_reactor [port]
+int main(int argc, char * argv[])
+{
+	unsigned short int const port = (argc > 1) ? (unsigned short int)(std::atoi(argv[1])) : 53100;
+	std::size_t const nb_client = 8;
+	std::size_t const nb_request = 200;
+	sf::Time const max_latency = sf::seconds(2);
+	
+	// Echo server with 2 I/O threads
+	std::atomic<std::size_t> nb_disconnection(0);
+	thoth::tcp_reactor server
+	(
+		port,
+		[](thoth::tcp & socket, sf::Packet & packet)
+		{
+			std::string s;
+			packet >> s;
+			socket.send(s);
+		},
+		nullptr,
+		[&](thoth::tcp &) { ++nb_disconnection; },
+		2
+	);
+	
+	// Client which sends big requests and never reads the replies (disconnected when its outgoing buffer is full)
+	std::atomic<bool> running(true);
+	std::atomic<bool> slow_reader_disconnected(false);
+	std::thread slow_reader
+	(
+		[&]()
+		{
+			sf::TcpSocket socket;
+			if (socket.connect("localhost", port) != sf::Socket::Done) { return; }
+			sf::Packet packet;
+			packet << std::string(64 * 1024, 'x');
+			while (running && socket.send(packet) == sf::Socket::Done) { }
+			slow_reader_disconnected = running.load();
+		}
+	);
+	
+	// Client which sends the size of a packet and half of the packet, then waits
+	sf::TcpSocket half_packet;
+	if (half_packet.connect("localhost", port) != sf::Socket::Done)
+	{
+		std::cerr << "Can not connect to localhost:" << port << std::endl;
+		running = false;
+		slow_reader.join();
+		return 1;
+	}
+	{
+		char const data[4 + 8] = { 0, 0, 0, 16, 'h', 'a', 'l', 'f', ' ', 'p', 'a', 'c' };
+		half_packet.send(data, sizeof(data));
+	}
+	
+	// Let the slow reader fill the buffers
+	sf::sleep(sf::milliseconds(200));
+	
+	// Normal clients: each reply must arrive
+	std::atomic<std::size_t> nb_reply(0);
+	std::atomic<std::size_t> nb_late(0);
+	std::vector<std::thread> clients;
+	for (std::size_t c = 0; c < nb_client; ++c)
+	{
+		clients.emplace_back
+		(
+			[&, c]()
+			{
+				sf::TcpSocket socket;
+				if (socket.connect("localhost", port) != sf::Socket::Done) { return; }
+				sf::SocketSelector selector;
+				selector.add(socket);
+				
+				for (std::size_t i = 0; i < nb_request; ++i)
+				{
+					std::string const request = "client " + std::to_string(c) + " request " + std::to_string(i);
+					sf::Packet packet;
+					packet << request;
+					if (socket.send(packet) != sf::Socket::Done) { return; }
+					
+					if (selector.wait(max_latency) == false) { ++nb_late; return; }
+					packet.clear();
+					std::string reply;
+					if (socket.receive(packet) != sf::Socket::Done || !(packet >> reply) || reply != request) { return; }
+					++nb_reply;
+				}
+			}
+		);
+	}
+	for (auto & client : clients) { client.join(); }
+	
+	// The slow reader must be disconnected by the server
+	sf::Clock clock;
+	while (slow_reader_disconnected == false && clock.getElapsedTime() < sf::seconds(10)) { sf::sleep(sf::milliseconds(10)); }
+	running = false;
+	slow_reader.join();
+	
+	std::cout << "Replies:            " << nb_reply << " / " << nb_client * nb_request << std::endl;
+	std::cout << "Late replies:       " << nb_late << std::endl;
+	std::cout << "Disconnections:     " << nb_disconnection << std::endl;
+	std::cout << "Slow reader:        " << (slow_reader_disconnected ? "disconnected" : "connected") << std::endl;
+	
+	bool const ok = (nb_reply == nb_client * nb_request && nb_late == 0 && slow_reader_disconnected);
+	std::cout << (ok ? "OK" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}